@@ -2,8 +2,12 @@
 
 layout (location = 0) in vec3 vertex;
 
-uniform mat4 projection;
-uniform mat4 view;
+// written once a frame by the Camera -- see CAMERA_UNIFORM_BINDING
+layout (std140, binding = 0) uniform Camera {
+	mat4 projection;
+	mat4 view;
+};
+
 uniform mat4 model;
 
 void main() {
@@ -3,7 +3,6 @@
 layout (location = 0) in vec2 vertex;
 
 uniform mat4 projection;
-uniform mat4 view;
 
 uniform vec2 position;
 uniform float width;
@@ -5,12 +5,20 @@ layout (location = 0) out vec3 f_color;
 in vec2 out_vertex;
 in vec2 out_uv;
 in float out_height;
+in vec2 out_tiles;
+flat in int out_top;
 
 uniform sampler2D tile_texture;
 
 void main() {
 	//f_color = vec3(1.0, 0, 0);
-	f_color = texture(tile_texture, out_uv).xyz;
+	// a merged block repeats the top's quarter of the texture once per tile
+	vec2 uv = out_uv;
+	if (out_top == 1) {
+		uv = vec2(0.5 + fract(out_tiles.x) * 0.5, 1.0 - fract(out_tiles.y) * 0.5);
+	}
+
+	f_color = texture(tile_texture, uv).xyz;
 	f_color = f_color * ((out_height * 0.5) + 1);
 	//f_color = vec3(out_uv.x, out_uv.y, 1);
 }
\ No newline at end of file
@@ -8,16 +8,24 @@ const int left_indices[3] = { 2, 1, 1 };
 
 layout (location = 0) in vec2 vertex;
 layout (location = 1) in vec2 uv;
+// one block of tiles per instance -- position and size in tiles, corner heights as in TileHeight
 layout (location = 2) in vec2 position;
+layout (location = 3) in vec2 size;
+layout (location = 4) in vec4 heights;
 
-uniform mat4 projection;
-uniform mat4 view;
+// written once a frame by the Camera -- see CAMERA_UNIFORM_BINDING
+layout (std140, binding = 0) uniform Camera {
+	mat4 projection;
+	mat4 view;
+};
 
-uniform samplerBuffer height;
+uniform vec2 tile_size;
 
 out vec2 out_vertex;
 out vec2 out_uv;
 out float out_height;
+out vec2 out_tiles;
+flat out int out_top;
 
 float get_height() {
 	const int side = gl_VertexID / 6;
@@ -44,21 +52,24 @@ float get_height() {
 					break;
 			}
 
-			return texelFetch(height, height_indices[side_vertex_index] + 4 * gl_InstanceID).r;
+			return heights[height_indices[side_vertex_index]];
 		}
 		else {
 			return 0.0f;		
 		}
 	}
 	
-	return texelFetch(height, height_indices[vertex_index] + 4 * gl_InstanceID).r;
+	return heights[height_indices[vertex_index]];
 }
 
 void main() {
 	float y = get_height();
-	out_vertex = vertex;
+	out_tiles = vertex * size;
+	out_vertex = out_tiles * tile_size;
 	out_uv = uv;
 	out_height = y;
-		
-	gl_Position = projection * view * vec4(vertex.x + position.x, y, vertex.y + position.y, 1.0);
+	out_top = gl_VertexID / 6 == 4 ? 1 : 0;
+
+	vec2 world = (position + out_tiles) * tile_size;
+	gl_Position = projection * view * vec4(world.x, y, world.y, 1.0);
 }
\ No newline at end of file
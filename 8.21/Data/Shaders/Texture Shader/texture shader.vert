@@ -3,10 +3,13 @@
 layout (location = 0) in vec3 vertex;
 layout (location = 1) in vec2 uv;
 layout (location = 2) in vec3 normal;
+layout (location = 3) in mat4 model;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+// written once a frame by the Camera -- see CAMERA_UNIFORM_BINDING
+layout (std140, binding = 0) uniform Camera {
+	mat4 projection;
+	mat4 view;
+};
 
 out vec2 out_uv;
 
@@ -4,8 +4,12 @@ layout (location = 0) in vec3 vertex;
 layout (location = 1) in vec2 uv;
 layout (location = 2) in vec3 normal;
 
-uniform mat4 projection;
-uniform mat4 view;
+// written once a frame by the Camera -- see CAMERA_UNIFORM_BINDING
+layout (std140, binding = 0) uniform Camera {
+	mat4 projection;
+	mat4 view;
+};
+
 uniform mat4 model;
 
 out vec2 out_uv;
@@ -0,0 +1,149 @@
+#include "CollisionResolver.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE
+#endif
+
+#include "../src/Entities/Entity.h"
+#include "../src/Entities/Components/TransformComponent.h"
+#include "../src/Utility/SpatialGrid.h"
+
+/********************************************************************************************************************************************************/
+
+void CollisionResolver::resolve(SlotMap<std::shared_ptr<Entity>>& entities, SpatialGrid& grid, TerrainData* terrain) {
+	_moved.clear();
+
+	const auto& ids = entities.ids();
+	auto& values = entities.values();
+	for (int i = 0; i < entities.size(); ++i) {
+		const auto transform = values[i]->get<TransformComponent>();
+		if (transform && transform->_moved) {
+			grid.update(ids[i], transform->get_collision_box());
+			_moved.push_back(ids[i]);
+		}
+	}
+
+	for (const auto id : _moved) {
+		const auto transform = (*entities.get(id))->get<TransformComponent>();
+		if (transform->_collidable) {
+			resolve(id, *transform, entities, grid, terrain);
+		}
+	}
+
+	// a pushed transform that hadnt moved itself keeps _moved and is resolved next tick
+	for (const auto id : _moved) {
+		(*entities.get(id))->get<TransformComponent>()->_moved = false;
+	}
+}
+
+void CollisionResolver::resolve(SlotId id, TransformComponent& transform, SlotMap<std::shared_ptr<Entity>>& entities, SpatialGrid& grid, TerrainData* terrain) {
+	CollisionBox box = transform.get_collision_box();
+
+	_candidate_ids.clear();
+	_candidate_boxes.clear();
+	grid.query_candidates(box, _candidate_ids, _candidate_boxes);
+
+	_batch.clear();
+	for (const auto& candidate : _candidate_boxes) {
+		_batch.push(candidate);
+	}
+	_batch.pad();
+
+	overlaps(box);
+
+	for (const auto i : _hits) {
+		const SlotId other_id = _candidate_ids[i];
+		if (other_id == id) {
+			continue;
+		}
+
+		const auto other_entity = entities.get(other_id);
+		const auto other = other_entity ? (*other_entity)->get<TransformComponent>() : nullptr;
+		if (!other || !other->_collidable) {
+			continue;
+		}
+
+		// an earlier push this pass may already have separated them
+		const CollisionBox other_box = other->get_collision_box();
+		if (!collision(box, other_box)) {
+			continue;
+		}
+
+		// out along the shallower of x / z
+		const float overlap_x = std::min(box.max.x, other_box.max.x) - std::max(box.min.x, other_box.min.x);
+		const float overlap_z = std::min(box.max.z, other_box.max.z) - std::max(box.min.z, other_box.min.z);
+
+		const glm::vec3 center = (box.min + box.max) * 0.5f;
+		const glm::vec3 other_center = (other_box.min + other_box.max) * 0.5f;
+
+		glm::vec3 dir(0.0f);
+		float overlap;
+		if (overlap_x < overlap_z) {
+			dir.x = center.x < other_center.x ? -1.0f : 1.0f;
+			overlap = overlap_x;
+		}
+		else {
+			dir.z = center.z < other_center.z ? -1.0f : 1.0f;
+			overlap = overlap_z;
+		}
+		overlap += COLLISION_SKIN;
+
+		const float share = other->_dest_reached ? 1.0f : 0.5f;
+
+		transform.move(dir, overlap * share, terrain);
+		box = transform.get_collision_box();
+		grid.update(id, box);
+
+		if (share < 1.0f) {
+			other->move(-dir, overlap * (1.0f - share), terrain);
+			grid.update(other_id, other->get_collision_box());
+		}
+	}
+}
+
+// same test as collision() -- touching boxes dont overlap
+void CollisionResolver::overlaps(const CollisionBox& box) {
+	_hits.clear();
+
+	const int count = _batch.size();
+
+#ifdef COLLISION_SSE
+	const __m128 a_min_x = _mm_set1_ps(box.min.x);
+	const __m128 a_min_y = _mm_set1_ps(box.min.y);
+	const __m128 a_min_z = _mm_set1_ps(box.min.z);
+	const __m128 a_max_x = _mm_set1_ps(box.max.x);
+	const __m128 a_max_y = _mm_set1_ps(box.max.y);
+	const __m128 a_max_z = _mm_set1_ps(box.max.z);
+
+	for (int i = 0; i < count; i += 4) {
+		__m128 apart = _mm_or_ps(_mm_cmple_ps(a_max_x, _mm_loadu_ps(&_batch.min_x[i])), _mm_cmpge_ps(a_min_x, _mm_loadu_ps(&_batch.max_x[i])));
+		apart = _mm_or_ps(apart, _mm_or_ps(_mm_cmple_ps(a_max_y, _mm_loadu_ps(&_batch.min_y[i])), _mm_cmpge_ps(a_min_y, _mm_loadu_ps(&_batch.max_y[i]))));
+		apart = _mm_or_ps(apart, _mm_or_ps(_mm_cmple_ps(a_max_z, _mm_loadu_ps(&_batch.min_z[i])), _mm_cmpge_ps(a_min_z, _mm_loadu_ps(&_batch.max_z[i]))));
+
+		const int mask = ~_mm_movemask_ps(apart) & 0xF;
+		if (!mask) {
+			continue;
+		}
+
+		for (int j = 0; j < 4; ++j) {
+			if (mask & (1 << j)) {
+				_hits.push_back(i + j);
+			}
+		}
+	}
+#else
+	for (int i = 0; i < count; ++i) {
+		const CollisionBox other = {
+			glm::vec3(_batch.min_x[i], _batch.min_y[i], _batch.min_z[i]),
+			glm::vec3(_batch.max_x[i], _batch.max_y[i], _batch.max_z[i])
+		};
+		if (collision(box, other)) {
+			_hits.push_back(i);
+		}
+	}
+#endif
+}
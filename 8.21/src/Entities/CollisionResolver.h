@@ -0,0 +1,39 @@
+#ifndef COLLISION_RESOLVER_H
+#define COLLISION_RESOLVER_H
+
+#include <vector>
+#include <memory>
+
+#include "../src/Utility/Collision.h"
+#include "../src/Utility/SlotMap.h"
+
+class Entity;
+class SpatialGrid;
+class TerrainData;
+class TransformComponent;
+
+// gap left between two boxes pushed apart so rounding doesnt leave them touching
+#define COLLISION_SKIN 0.001f
+
+// Pushes collidable transforms out of each other once they have moved for the tick
+// broadphase: the SpatialGrid cells a mover covers -- narrowphase: its box against all of them 4 at a time
+// a mover shares the push with another mover and takes all of it against anything standing still
+class CollisionResolver {
+public:
+	// re-files every transform that moved in grid then resolves them -- clears _moved
+	void resolve(SlotMap<std::shared_ptr<Entity>>& entities, SpatialGrid& grid, TerrainData* terrain);
+private:
+	void resolve(SlotId id, TransformComponent& transform, SlotMap<std::shared_ptr<Entity>>& entities, SpatialGrid& grid, TerrainData* terrain);
+
+	// indices into the batch of boxes overlapping box
+	void overlaps(const CollisionBox& box);
+
+	std::vector<SlotId> _moved;
+
+	std::vector<SlotId> _candidate_ids;
+	std::vector<CollisionBox> _candidate_boxes;
+	CollisionBatch _batch;
+	std::vector<int> _hits;
+};
+
+#endif
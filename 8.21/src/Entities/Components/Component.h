@@ -5,6 +5,7 @@
 #include <fstream>
 
 #include "../src/Network/Packet.h"
+#include "ComponentPool.h"
 
 enum
 {
@@ -14,15 +15,15 @@ enum
 
 class Entity;
 
+// Components live in a ComponentPool per type -- the entity owns them through handles
+// _entity is not owning, a component never outlives its entity
 class Component {
 public:
-	Component(std::shared_ptr<Entity> entity) :
+	Component(Entity* entity) :
 		_entity		(entity)
 	{}
 	~Component() {}
 
-	virtual std::shared_ptr<Component> copy(std::shared_ptr<Entity> new_entity) const = 0;
-
 	virtual void update() = 0;
 
 	virtual const int get_type() const = 0;
@@ -31,9 +32,10 @@ public:
 
 	virtual PacketData packet_data() = 0;
 
-	virtual int load_buffer(void* buf) = 0;
+	// bytes read -- -1 if the component runs past size
+	virtual int load_buffer(void* buf, int size) = 0;
 
-	std::shared_ptr<Entity> _entity;
+	Entity* _entity;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,232 @@
+#ifndef COMPONENT_POOL_H
+#define COMPONENT_POOL_H
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <cassert>
+#include <algorithm>
+
+// components per chunk -- a chunk never moves so component pointers stay valid until destroy()
+#define COMPONENT_CHUNK_SIZE 1024
+#define COMPONENT_MAX_CHUNKS 256
+
+#define INVALID_COMPONENT 0xFFFFFFFF
+
+// slot index + the generation of the slot when the component was made
+// a handle to a destroyed component never matches again
+struct ComponentHandle {
+	uint32_t index = INVALID_COMPONENT;
+	uint32_t generation = 0;
+
+	bool valid() const { return index != INVALID_COMPONENT; }
+};
+
+// Every component of one type in chunks of contiguous slots
+// systems walk the slots in order instead of chasing entity pointers
+// create() / destroy() / for_each() lock -- get() doesnt, chunks and slot state are atomics so it can run beside them
+// destroy() only retires a slot -- the component is destructed and the slot reused by the next collect()
+// so a pointer from get() stays valid until then even if another thread destroys it
+template<typename T>
+class ComponentPool {
+public:
+	ComponentPool();
+	~ComponentPool();
+
+	template<typename ... Args>
+	ComponentHandle create(Args&& ... args);
+	void destroy(ComponentHandle handle);
+	// frees everything destroy() retired -- once per update, no pointer from get() may be kept past it
+	void collect();
+
+	// nullptr if the handle is stale -- valid until the next collect()
+	T* get(ComponentHandle handle);
+
+	// func runs under the lock -- it must not create() or destroy() in this pool
+	template<typename Func>
+	void for_each(Func func);
+
+	// locked(func) holds the lock while func(end) hands slot ranges below end to for_range()
+	// for_range() doesnt lock -- any thread can walk a range while locked() is running
+	template<typename Func>
+	void locked(Func func);
+	template<typename Func>
+	void for_range(uint32_t begin, uint32_t end, Func func);
+
+	int size();
+private:
+	struct Slot {
+		alignas(T) unsigned char data[sizeof(T)];
+		std::atomic<uint32_t> generation { 0 };
+		std::atomic<bool> alive { false };
+
+		T* get() { return std::launder(reinterpret_cast<T*>(data)); }
+	};
+
+	struct Chunk {
+		Slot slots[COMPONENT_CHUNK_SIZE];
+	};
+
+	Slot& slot(uint32_t index);
+
+	// a chunk is published once and freed with the pool
+	std::array<std::atomic<Chunk*>, COMPONENT_MAX_CHUNKS> _chunks;
+
+	// slots below _end have been used -- for_each() stops there
+	uint32_t _end;
+	std::vector<uint32_t> _free;
+	// destroyed but not yet destructed -- moved to _free by collect()
+	std::vector<uint32_t> _retired;
+	int _size;
+
+	std::mutex _mutex;
+};
+
+template<typename T>
+ComponentPool<T>::ComponentPool() :
+	_end			( 0 ),
+	_size			( 0 )
+{
+	for (auto& chunk : _chunks) {
+		chunk.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+template<typename T>
+ComponentPool<T>::~ComponentPool() {
+	for (uint32_t i = 0; i < _end; ++i) {
+		Slot& s = slot(i);
+		if (s.alive.load(std::memory_order_relaxed)) {
+			s.get()->~T();
+		}
+	}
+
+	for (const uint32_t index : _retired) {
+		slot(index).get()->~T();
+	}
+
+	for (auto& chunk : _chunks) {
+		delete chunk.load(std::memory_order_relaxed);
+	}
+}
+
+template<typename T>
+template<typename ... Args>
+ComponentHandle ComponentPool<T>::create(Args&& ... args) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	uint32_t index;
+	if (!_free.empty()) {
+		index = _free.back();
+		_free.pop_back();
+	}
+	else {
+		index = _end++;
+		const uint32_t chunk = index / COMPONENT_CHUNK_SIZE;
+		assert(chunk < COMPONENT_MAX_CHUNKS);
+		if (!_chunks[chunk].load(std::memory_order_relaxed)) {
+			_chunks[chunk].store(new Chunk, std::memory_order_release);
+		}
+	}
+
+	Slot& s = slot(index);
+	new (s.data) T(std::forward<Args>(args)...);
+	const uint32_t generation = s.generation.load(std::memory_order_relaxed);
+	s.alive.store(true, std::memory_order_release);
+	++_size;
+
+	return { index, generation };
+}
+
+template<typename T>
+void ComponentPool<T>::destroy(ComponentHandle handle) {
+	if (!handle.valid()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	Slot& s = slot(handle.index);
+	if (!s.alive.load(std::memory_order_relaxed) || s.generation.load(std::memory_order_relaxed) != handle.generation) {
+		return;
+	}
+
+	// a get() from here on sees the new generation or a dead slot
+	s.generation.fetch_add(1, std::memory_order_release);
+	s.alive.store(false, std::memory_order_release);
+	--_size;
+
+	_retired.push_back(handle.index);
+}
+
+template<typename T>
+void ComponentPool<T>::collect() {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (const uint32_t index : _retired) {
+		slot(index).get()->~T();
+		_free.push_back(index);
+	}
+	_retired.clear();
+}
+
+template<typename T>
+T* ComponentPool<T>::get(ComponentHandle handle) {
+	if (!handle.valid()) {
+		return nullptr;
+	}
+
+	// only create() hands out indices so the chunk is already published
+	Slot& s = slot(handle.index);
+	return s.alive.load(std::memory_order_acquire) && s.generation.load(std::memory_order_acquire) == handle.generation ? s.get() : nullptr;
+}
+
+template<typename T>
+template<typename Func>
+void ComponentPool<T>::for_each(Func func) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for (uint32_t c = 0; c * COMPONENT_CHUNK_SIZE < _end; ++c) {
+		Slot* slots = _chunks[c].load(std::memory_order_relaxed)->slots;
+		const uint32_t count = std::min<uint32_t>(COMPONENT_CHUNK_SIZE, _end - c * COMPONENT_CHUNK_SIZE);
+		for (uint32_t i = 0; i < count; ++i) {
+			if (slots[i].alive.load(std::memory_order_relaxed)) {
+				func(*slots[i].get());
+			}
+		}
+	}
+}
+
+template<typename T>
+template<typename Func>
+void ComponentPool<T>::locked(Func func) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	func(_end);
+}
+
+template<typename T>
+template<typename Func>
+void ComponentPool<T>::for_range(uint32_t begin, uint32_t end, Func func) {
+	for (uint32_t i = begin; i < end; ++i) {
+		Slot& s = slot(i);
+		if (s.alive.load(std::memory_order_acquire)) {
+			func(*s.get());
+		}
+	}
+}
+
+template<typename T>
+int ComponentPool<T>::size() {
+	return _size;
+}
+
+template<typename T>
+typename ComponentPool<T>::Slot& ComponentPool<T>::slot(uint32_t index) {
+	return _chunks[index / COMPONENT_CHUNK_SIZE].load(std::memory_order_acquire)->slots[index % COMPONENT_CHUNK_SIZE];
+}
+
+#endif
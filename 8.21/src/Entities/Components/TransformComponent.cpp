@@ -9,10 +9,66 @@
 
 #include "../src/Utility/FileReader.h"
 
+#include "../src/Network/Replication.h"
+#include "../src/Utility/JobSystem.h"
+#include "../src/Utility/FlowField.h"
+
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 
 constexpr float ROTATION_SPEED = 100000.0f;
 
+// fewest transform slots per job
+constexpr int TRANSFORM_JOB_GRAIN = 256;
+
+// longest move in one sub step -- keeps units on the terrain and stops them stepping past their destination
+constexpr float MAX_STEP_DISTANCE = 0.25f;
+
+// transforms one update_all() range moved -- their heights are sampled in one exact_heights() call
+struct HeightBatch {
+	std::vector<TransformComponent*> transforms;
+	std::vector<float> x;
+	std::vector<float> z;
+	std::vector<float> y;
+
+	void clear() {
+		transforms.clear();
+		x.clear();
+		z.clear();
+	}
+
+	void add(TransformComponent& transform) {
+		const glm::vec3 position = transform._transform.get_position();
+		transforms.push_back(&transform);
+		x.push_back(position.x);
+		z.push_back(position.z);
+	}
+
+	void resolve(TerrainData* terrain) {
+		if (!terrain || transforms.empty()) {
+			return;
+		}
+
+		y.resize(transforms.size());
+		terrain->exact_heights(x.data(), z.data(), y.data(), (int)transforms.size());
+
+		for (size_t i = 0; i < transforms.size(); ++i) {
+			glm::vec3 position = transforms[i]->_transform.get_position();
+			position.y = y[i];
+			transforms[i]->_transform.set_position(position);
+		}
+	}
+};
+
+// packet_data() flags -- optional fields are only sent when set
+enum {
+	WIRE_SCALE			= 1 << 0,	// vec3 scale follows -- otherwise 1, 1, 1
+	WIRE_ROTATION		= 1 << 1,	// vec3 rotation follows -- otherwise only a quantized yaw
+	WIRE_DESTINATION	= 1 << 2,	// vec3 destination follows -- not at its destination
+	WIRE_COLLIDABLE		= 1 << 3
+};
+
 ReadTransformFile::ReadTransformFile(FileReader& file, std::string_view section) {
 	if (file.set_section(section)) {
 		std::string data;
@@ -38,57 +94,115 @@ ReadTransformFile::ReadTransformFile(FileReader& file, std::string_view section)
 }
 
 TransformComponent::TransformComponent() :
-	Component				( nullptr )
+	Component				( nullptr ),
+	_path_index				( 0 ),
+	_arrive_radius			( 0 ),
+	_moved					( false )
 {}
 
-TransformComponent::TransformComponent(std::shared_ptr<Entity> entity) :
+TransformComponent::TransformComponent(Entity* entity) :
 	Component				( entity ),
-	_speed					( 0 ),
-	_collidable				( 0 ),
 	_direction				( glm::vec3(0, 0, 0) ),
 	_destination			( glm::vec3(0, 0, 0) ),
-	_dest_reached			( true ),
+	_path_index				( 0 ),
+	_arrive_radius			( 0 ),
 	_y_rot					( 0 ),
-	_turn					( 0 )
+	_turn					( 0 ),
+	_speed					( 0 ),
+	_collidable				( 0 ),
+	_dest_reached			( true ),
+	_moved					( false )
 {}
 
-TransformComponent::TransformComponent(std::shared_ptr<Entity> entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable) :
+TransformComponent::TransformComponent(Entity* entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable) :
 	Component				( entity ),
 	_transform				( position, scale, rotation ),
-	_speed					( speed ),
-	_collidable				( collidable ),
 	_direction				( glm::vec3(0, 0, 0) ),
 	_destination			( glm::vec3(0, 0, 0) ),
-	_dest_reached			( true ),
+	_path_index				( 0 ),
+	_arrive_radius			( 0 ),
 	_y_rot					( 0 ),
-	_turn					( 0 )
+	_turn					( 0 ),
+	_speed					( speed ),
+	_collidable				( collidable ),
+	_dest_reached			( true ),
+	_moved					( false )
 {
-	const auto c_box = Environment::get().get_resource_manager()->get_model(_entity->get_model_id())->get_collision_box();
-	_collision_box.min = _transform.get_scale() * c_box.min;
-	_collision_box.max = _transform.get_scale() * c_box.max;
+	load_collision_box();
 }
 
-TransformComponent::TransformComponent(std::shared_ptr<Entity> new_entity, const TransformComponent& rhs) :
+TransformComponent::TransformComponent(Entity* new_entity, const TransformComponent& rhs) :
 	Component				( new_entity ),
 	_transform				( rhs._transform ),
-	_speed					( rhs._speed ),
-	_collidable				( rhs._collidable),
 	_direction				( rhs._direction ),
 	_destination			( rhs._destination ),
-	_dest_reached			( rhs._dest_reached ),
+	_path					( rhs._path ),
+	_path_index				( rhs._path_index ),
+	_flow_field				( rhs._flow_field ),
+	_arrive_radius			( rhs._arrive_radius ),
 	_y_rot					( rhs._y_rot ),
 	_turn					( rhs._turn ),
+	_speed					( rhs._speed ),
+	_collidable				( rhs._collidable),
+	_dest_reached			( rhs._dest_reached ),
+	_moved					( false ),
 	_collision_box			( rhs._collision_box )
 {}
 
-std::shared_ptr<Component> TransformComponent::copy(std::shared_ptr<Entity> new_entity) const {
-	return std::static_pointer_cast<Component>(std::make_shared<TransformComponent>(new_entity, *this));
+// never destroyed -- entities held by statics can outlive it otherwise
+ComponentPool<TransformComponent>& TransformComponent::pool() {
+	static ComponentPool<TransformComponent>* pool = new ComponentPool<TransformComponent>;
+	return *pool;
 }
 
-void TransformComponent::update() {
+// transforms only touch themselves and read the terrain so ranges run in parallel
+void TransformComponent::update_all() {
+	// the start of an update is where pointers from the last one are let go
+	pool().collect();
 
-	if(!_dest_reached) {
-		move(_destination - _transform.get_position());
+	// clients dont simulate movement -- see update()
+	if (Environment::get().get_mode() == MODE_ENGINE) {
+		return;
+	}
+
+	const auto terrain_data = Environment::get().get_resource_manager()->get_terrain_data();
+	TerrainData* terrain = terrain_data.get();
+	const float dt = (float)Environment::get().get_clock()->get_step();
+
+	auto& transforms = pool();
+	JobSystem* jobs = Environment::get().get_job_system();
+
+	// heights are left until the whole range has moved
+	const auto update = [&transforms, terrain, dt](uint32_t range_begin, uint32_t range_end) {
+		thread_local HeightBatch batch;
+		batch.clear();
+
+		transforms.for_range(range_begin, range_end, [&](TransformComponent& transform) {
+			if (!transform._dest_reached) {
+				transform.integrate(dt, nullptr);
+				batch.add(transform);
+			}
+		});
+
+		batch.resolve(terrain);
+	};
+
+	transforms.locked([&](uint32_t end) {
+		if (!jobs) {
+			update(0, end);
+			return;
+		}
+
+		jobs->parallel_for(0, (int)end, TRANSFORM_JOB_GRAIN, [&](int range_begin, int range_end) {
+			update(range_begin, range_end);
+		});
+	});
+}
+
+void TransformComponent::update() {
+	// clients dont simulate movement -- Client::c_interpolate() places replicated entities
+	if(!_dest_reached && Environment::get().get_mode() != MODE_ENGINE) {
+		integrate((float)Environment::get().get_clock()->get_step(), Environment::get().get_resource_manager()->get_terrain_data().get());
 	}
 	/*
 	auto rotation = _transform.get_rotation();
@@ -135,16 +249,80 @@ void TransformComponent::save(std::ofstream& file) {
 	file << '\n';
 }
 
-void TransformComponent::move(glm::vec3 dir) {
-	dir = glm::normalize(dir);
+// Moves toward the next waypoint or _destination for dt seconds at _speed units per second
+// split into sub steps of at most MAX_STEP_DISTANCE -- arriving at the last one sets _dest_reached
+void TransformComponent::integrate(float dt, TerrainData* terrain) {
+	const float distance = _speed * dt;
+	const int steps = std::max(1, (int)std::ceil(distance / MAX_STEP_DISTANCE));
+	const float step = distance / steps;
+
+	for(int i = 0; i < steps; ++i) {
+		if(_flow_field) {
+			const glm::vec3 position = _transform.get_position();
+			glm::vec3 target = _destination;
+
+			// a group stops around the destination rather than all on it
+			glm::vec3 to = _destination - position;
+			to.y = 0.0f;
+			const bool arrived = glm::length(to) <= _arrive_radius;
+
+			if(arrived || (!_flow_field->at_goal(position) && !_flow_field->next(position, &target))) {
+				_flow_field.reset();
+				_dest_reached = true;
+				return;
+			}
+
+			to = target - position;
+			to.y = 0.0f;
+
+			const float remaining = glm::length(to);
+			if(remaining <= step) {
+				move(to, 1.0f, terrain);
+				if(target == _destination) {
+					_flow_field.reset();
+					_dest_reached = true;
+					return;
+				}
+				continue;
+			}
+
+			move(to / remaining, step, terrain);
+			continue;
+		}
+
+		const bool waypoint = _path_index < (int)_path.size() - 1;
+		glm::vec3 to = (waypoint ? _path[_path_index] : _destination) - _transform.get_position();
+		to.y = 0.0f;
+
+		const float remaining = glm::length(to);
+		if(remaining <= step) {
+			// to is the rest of the way
+			move(to, 1.0f, terrain);
+			if(waypoint) {
+				++_path_index;
+				continue;
+			}
+			_path.clear();
+			_path_index = 0;
+			_dest_reached = true;
+			return;
+		}
+
+		move(to / remaining, step, terrain);
+	}
+}
+
+// moves dir * distance -- y is ignored, units follow the terrain
+// with no terrain y is left as it was for the caller to sample
+void TransformComponent::move(glm::vec3 dir, float distance, TerrainData* terrain) {
 	glm::vec3 old_position = _transform.get_position();
 
-	const auto terrain = Environment::get().get_resource_manager()->get_terrain();
-	const float x = _transform.get_position().x + dir.x * _speed;
-	const float z = _transform.get_position().z + dir.z * _speed;
-	const float y = terrain->exact_height(x, z);
+	const float x = _transform.get_position().x + dir.x * distance;
+	const float z = _transform.get_position().z + dir.z * distance;
+	const float y = terrain ? terrain->exact_height(x, z) : old_position.y;
 
 	_transform.set_position(glm::vec3(x, y, z));
+	_moved = true;
 
 	/*
 	if(_entity->is_collision()) {
@@ -159,6 +337,7 @@ void TransformComponent::move(glm::vec3 dir) {
 
 void TransformComponent::set(glm::vec3 pos) {
 	_transform.set_position(pos);
+	_moved = true;
 }
 
 void TransformComponent::set_direction(glm::vec3 dir) {
@@ -187,64 +366,166 @@ void TransformComponent::set_direction(glm::vec3 dir) {
 	}
 }
 
+// straight there
 void TransformComponent::set_destination(glm::vec3 dest) {
+	_path.clear();
+	_path_index = 0;
+	_flow_field.reset();
 	_destination = dest;
 	_dest_reached = false;
 }
 
+bool TransformComponent::set_path(const std::vector<glm::vec3>& waypoints, int first, bool repair) {
+	// a repair for a path it already finished
+	if (waypoints.empty() || (repair && _dest_reached)) {
+		return false;
+	}
+
+	_path_index = _path.empty() ? first : std::min(_path_index, first);
+	_path = waypoints;
+	_destination = waypoints.back();
+	_dest_reached = false;
+	_flow_field.reset();
+	return true;
+}
+
+bool TransformComponent::set_flow_field(std::shared_ptr<const FlowField> field, glm::vec3 dest, float radius, bool repair) {
+	if (!field || (repair && _dest_reached)) {
+		return false;
+	}
+
+	_path.clear();
+	_path_index = 0;
+	_flow_field = std::move(field);
+	_destination = dest;
+	_arrive_radius = radius;
+	_dest_reached = false;
+	return true;
+}
+
+void TransformComponent::load_collision_box() {
+	const auto c_box = Environment::get().get_resource_manager()->get_model(_entity->get_model_id())->get_collision_box();
+	_collision_box.min = _transform.get_scale() * c_box.min;
+	_collision_box.max = _transform.get_scale() * c_box.max;
+}
+
+// _collision_box is already scaled by load_collision_box()
 CollisionBox TransformComponent::get_collision_box() {
-	return { _collision_box.max * _transform.get_scale() + _transform.get_position(),
-		     _collision_box.min * _transform.get_scale() + _transform.get_position()
+	return { _collision_box.min + _transform.get_position(),
+		     _collision_box.max + _transform.get_position()
+	};
+}
+
+// the model turns about its position so its furthest xz corner bounds every turn
+CollisionBox TransformComponent::get_draw_box() {
+	const float x = std::max(std::abs(_collision_box.min.x), std::abs(_collision_box.max.x));
+	const float z = std::max(std::abs(_collision_box.min.z), std::abs(_collision_box.max.z));
+	const float radius = std::sqrt(x * x + z * z);
+
+	const glm::vec3 position = _transform.get_position();
+	return { glm::vec3(position.x - radius, position.y + _collision_box.min.y, position.z - radius),
+			 glm::vec3(position.x + radius, position.y + _collision_box.max.y, position.z + radius)
 	};
 }
 
+// uint8 flags, vec3 position, float speed, (vec3 rotation | uint16 yaw), [vec3 scale], [vec3 destination]
+// every field is written on its own so struct layout / padding never hits the wire
 PacketData TransformComponent::packet_data() {
-	return std::move(PacketData("Transform", _transform, _direction, _destination, _y_rot, _turn, _speed, _collidable, _dest_reached, _collision_box));
+	const glm::vec3 position = _transform.get_position();
+	const glm::vec3 scale = _transform.get_scale();
+	const glm::vec3 rotation = _transform.get_rotation();
+
+	uint8_t flags = 0;
+	if (scale != glm::vec3(1.0f, 1.0f, 1.0f))	flags |= WIRE_SCALE;
+	if (rotation.x != 0.0f || rotation.z != 0.0f)	flags |= WIRE_ROTATION;
+	if (!_dest_reached)							flags |= WIRE_DESTINATION;
+	if (_collidable)							flags |= WIRE_COLLIDABLE;
+
+	PacketData packet("Transform", flags, position.x, position.y, position.z, _speed);
+
+	if (flags & WIRE_ROTATION) {
+		packet.add(rotation.x, rotation.y, rotation.z);
+	}
+	else {
+		packet.add(quantize_yaw(rotation.y));
+	}
+
+	if (flags & WIRE_SCALE) {
+		packet.add(scale.x, scale.y, scale.z);
+	}
+
+	if (flags & WIRE_DESTINATION) {
+		packet.add(_destination.x, _destination.y, _destination.z);
+	}
+
+	return packet;
 }
 
-int TransformComponent::load_buffer(void* buf) {
-	uint8_t* ptr = static_cast<uint8_t*>(buf);
-	int byte = 0;
+glm::vec3 read_vec3(const uint8_t* ptr) {
+	glm::vec3 v;
+	memcpy(&v.x, ptr, sizeof(float));
+	memcpy(&v.y, ptr + sizeof(float), sizeof(float));
+	memcpy(&v.z, ptr + sizeof(float) * 2, sizeof(float));
+	return v;
+}
 
-	Transform* t_ptr = static_cast<Transform*>(static_cast<void*>(ptr));
-	std::copy(t_ptr, t_ptr + 1, &_transform);
-	ptr += sizeof(Transform);
-	byte += sizeof(Transform);
+#define VEC3_SIZE (sizeof(float) * 3)
 
-	glm::vec3* v_ptr = static_cast<glm::vec3*>(static_cast<void*>(ptr));
-	std::copy(v_ptr, v_ptr + 1, &_direction);
-	ptr += sizeof(glm::vec3);
-	byte += sizeof(glm::vec3);
+// matrices aren't touched here -- Transform rebuilds them the first time get_model() is called
+int TransformComponent::load_buffer(void* buf, int size) {
+	const uint8_t* ptr = static_cast<uint8_t*>(buf);
+	const uint8_t* start = ptr;
 
-	v_ptr = static_cast<glm::vec3*>(static_cast<void*>(ptr));
-	std::copy(v_ptr, v_ptr + 1, &_destination);
-	ptr += sizeof(glm::vec3);
-	byte += sizeof(glm::vec3);
+	if (size < (int)sizeof(uint8_t)) {
+		return -1;
+	}
 
-	std::copy(ptr, ptr + sizeof(float), &_y_rot);
-	ptr += sizeof(float);
-	byte += sizeof(float);
+	const uint8_t flags = *ptr;
+	ptr += sizeof(uint8_t);
+
+	// the flags say which fields follow -- check they all fit before reading any
+	int bytes = sizeof(uint8_t) + VEC3_SIZE + sizeof(float);
+	bytes += (flags & WIRE_ROTATION) ? VEC3_SIZE : sizeof(uint16_t);
+	bytes += (flags & WIRE_SCALE) ? VEC3_SIZE : 0;
+	bytes += (flags & WIRE_DESTINATION) ? VEC3_SIZE : 0;
+	if (bytes > size) {
+		return -1;
+	}
 
-	std::copy(ptr, ptr + sizeof(int), &_turn);
-	ptr += sizeof(int);
-	byte += sizeof(int);
+	_transform.set_position(read_vec3(ptr));
+	ptr += VEC3_SIZE;
 
-	std::copy(ptr, ptr + sizeof(float), &_speed);
+	memcpy(&_speed, ptr, sizeof(float));
 	ptr += sizeof(float);
-	byte += sizeof(float);
 
-	std::copy(ptr, ptr + sizeof(bool), &_collidable);
-	ptr += sizeof(bool);
-	byte += sizeof(bool);
+	if (flags & WIRE_ROTATION) {
+		_transform.set_rotation(read_vec3(ptr));
+		ptr += VEC3_SIZE;
+	}
+	else {
+		uint16_t yaw;
+		memcpy(&yaw, ptr, sizeof(uint16_t));
+		ptr += sizeof(uint16_t);
+		_transform.set_rotation(glm::vec3(0.0f, dequantize_yaw(yaw), 0.0f));
+	}
 
-	std::copy(ptr, ptr + sizeof(bool), &_dest_reached);
-	ptr += sizeof(bool);
-	byte += sizeof(bool);
+	if (flags & WIRE_SCALE) {
+		_transform.set_scale(read_vec3(ptr));
+		ptr += VEC3_SIZE;
+	}
+	else {
+		_transform.set_scale(glm::vec3(1.0f, 1.0f, 1.0f));
+	}
+
+	_dest_reached = !(flags & WIRE_DESTINATION);
+	if (!_dest_reached) {
+		_destination = read_vec3(ptr);
+		ptr += VEC3_SIZE;
+	}
+
+	_collidable = (flags & WIRE_COLLIDABLE) != 0;
 
-	CollisionBox* c_ptr = static_cast<CollisionBox*>(static_cast<void*>(ptr));
-	std::copy(c_ptr, c_ptr + 1, &_collision_box);
-	ptr += sizeof(CollisionBox);
-	byte += sizeof(CollisionBox);
+	load_collision_box();
 
-	return byte;
-}
\ No newline at end of file
+	return ptr - start;
+}
@@ -4,11 +4,16 @@
 #include "Component.h"
 #include "../src/Resources/Model.h"
 
+#include <vector>
+#include <memory>
+
 #define TURN_CLOCKWISE 0
 #define TURN_CCLOCKWISE 1
 
 class Entity;
 class FileReader;
+class TerrainData;
+class FlowField;
 
 struct ReadTransformFile {
 	ReadTransformFile(FileReader& file, std::string_view section = "Transform");
@@ -16,17 +21,22 @@ struct ReadTransformFile {
 	glm::vec3 _position = glm::vec3(0, 0, 0);
 	glm::vec3 _scale = glm::vec3(1, 1, 1);
 	glm::vec3 _rotation = glm::vec3(0, 0, 0);
-	float _speed = 0.01f;
+	// units per second
+	float _speed = 0.2f;
 	bool _collidable = true;
 };
 
 class TransformComponent : public Component {
 public:
 	TransformComponent();
-	TransformComponent(std::shared_ptr<Entity> entity);
-	TransformComponent(std::shared_ptr<Entity> entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable);
-	TransformComponent(std::shared_ptr<Entity> new_entity, const TransformComponent& rhs);
-	std::shared_ptr<Component> copy(std::shared_ptr<Entity> new_entity) const;
+	TransformComponent(Entity* entity);
+	TransformComponent(Entity* entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable);
+	TransformComponent(Entity* new_entity, const TransformComponent& rhs);
+
+	static ComponentPool<TransformComponent>& pool();
+
+	// every transform in pool order -- split across the environment's JobSystem if it has one
+	static void update_all();
 
 	void update();
 
@@ -38,19 +48,37 @@ public:
 
 	PacketData packet_data();
 
-	int load_buffer(void* buf);
+	int load_buffer(void* buf, int size);
 
-	void move(glm::vec3 dir);
+	// no terrain leaves y where it was -- update_all() samples a whole range's heights at once
+	void integrate(float dt, TerrainData* terrain);
+	void move(glm::vec3 dir, float distance, TerrainData* terrain);
 	void set(glm::vec3 pos);
 	void set_direction(glm::vec3 dir);
 	void set_destination(glm::vec3 dest);
+	// walks waypoints in order -- the last one is the destination
+	// first is where a repaired path changes, the transform keeps its place if it hasnt got that far yet
+	// false if it was a repair for a path already finished
+	bool set_path(const std::vector<glm::vec3>& waypoints, int first = 0, bool repair = false);
+	// follows field until within radius of dest -- false if it was a repair and the transform already arrived
+	bool set_flow_field(std::shared_ptr<const FlowField> field, glm::vec3 dest, float radius, bool repair = false);
 
 	CollisionBox get_collision_box();
+	// get_collision_box() widened on xz to hold the model however it is turned -- what culling tests
+	CollisionBox get_draw_box();
+	void load_collision_box();
 
 	Transform _transform;
 
 	glm::vec3 _direction;
 	glm::vec3 _destination;
+
+	// server only -- _path[_path_index] is the current heading, _destination is still what clients are sent
+	std::vector<glm::vec3> _path;
+	int _path_index;
+	// server only -- shared with the rest of the group, followed instead of _path
+	std::shared_ptr<const FlowField> _flow_field;
+	float _arrive_radius;
 	float _y_rot;
 	int _turn;
 
@@ -59,6 +87,9 @@ public:
 	bool _collidable;
 	bool _dest_reached;
 
+	// set by move() / set() -- the entity manager moves the entity in its SpatialGrid and clears it
+	bool _moved;
+
 	CollisionBox _collision_box;
 
 };
@@ -2,12 +2,9 @@
 
 #include "../src/Utility/FileReader.h"
 
-#define ENTITY_FILE "Data\\Entities\\entities.txt"
+#include <cstring>
 
-unsigned int make_unique_id() {
-	static unsigned int id = 0;
-	return id++;
-}
+#define ENTITY_FILE "Data/Entities/entities.txt"
 
 ReadEntityFile::ReadEntityFile(const char* file_path, std::string_view section) {
 	FileReader file(file_path);
@@ -55,11 +52,10 @@ std::string EntityLoader::default_file(std::string_view type, int id) {
 	return path;
 }
 
-// TransformComponent(std::shared_ptr<Entity> entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable);
+// TransformComponent(Entity* entity, glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, float speed, bool collidable);
 void EntityLoader::load_transform() {
 	const auto transform_file = _entity_file._transform_file;
-	_entity->_components[TRANSFORM_COMPONENT] = std::make_shared<TransformComponent>(
-		_entity,
+	_entity->add<TransformComponent>(
 		transform_file->_position,
 		transform_file->_scale,
 		transform_file->_rotation,
@@ -69,7 +65,7 @@ void EntityLoader::load_transform() {
 }
 
 Entity::Entity() :
-	_unique_id		    ( make_unique_id() ),
+	_unique_id		    ( INVALID_ENTITY_ID ),
 	_id			   	    ( -1 ),
 	_model_id			( 0 ),
 	_destroy			( false ),
@@ -79,7 +75,7 @@ Entity::Entity() :
 {}
 
 Entity::Entity(const std::string_view type, const int id) :
-	_unique_id			( make_unique_id() ),
+	_unique_id			( INVALID_ENTITY_ID ),
 	_type				( type ),
 	_id					( id ),
 	_model_id			( 0 ),
@@ -90,7 +86,7 @@ Entity::Entity(const std::string_view type, const int id) :
 }
 
 Entity::Entity(const Entity& rhs) :
-	_unique_id			( make_unique_id() ),
+	_unique_id			( INVALID_ENTITY_ID ),
 	_type				( rhs._type ),
 	_id					( rhs._id ),
 	_model_id			( rhs._model_id ),
@@ -102,31 +98,35 @@ Entity::Entity(const Entity& rhs) :
 }
 
 Entity::~Entity() {
+	clear();
 }
 
-void Entity::add(std::shared_ptr<Component> component) {
-	_components[component->get_type()] = component;
+// one case per component type
+Component* Entity::get(int type) const {
+	switch(type) {
+	case TRANSFORM_COMPONENT:	return get<TransformComponent>();
+	default:					return nullptr;
+	}
 }
 
+// systems update components in bulk -- TransformComponent::update_all()
 void Entity::update() {
-	for(auto c : _components) {
-		if (c) {
+	for(int i = 0; i < TOTAL_COMPONENTS; ++i) {
+		if (const auto c = get(i)) {
 			c->update();
 		}
 	}
 }
 
+// one line per component type
 void Entity::clear() {
-	for(auto c : _components) {
-		c = nullptr;
-	}
+	remove<TransformComponent>();
 }
 
+// one line per component type
 void Entity::copy(const Entity& rhs) {
-	for (size_t i = 0; i < TOTAL_COMPONENTS; ++i) {
-		if (rhs._components[i]) {
-			_components[i] = rhs._components[i]->copy(shared_from_this());
-		}
+	if (const auto transform = rhs.get<TransformComponent>()) {
+		add<TransformComponent>(*transform);
 	}
 }
 
@@ -159,14 +159,14 @@ void Entity::save(std::ofstream& file) {
 	file << "draw " << _draw << '\n';
 	file << '\n';
 
-	for(const auto& c : _components) {
-		if(c) {
+	for(int i = 0; i < TOTAL_COMPONENTS; ++i) {
+		if(const auto c = get(i)) {
 			c->save(file);
 		}
 	}
 }
 
-unsigned int Entity::get_unique_id() {
+EntityId Entity::get_unique_id() {
 	return _unique_id;
 }
 
@@ -186,7 +186,7 @@ std::string_view Entity::get_name() {
 	return _name;
 }
 
-void Entity::set_unique_id(int id) {
+void Entity::set_unique_id(EntityId id) {
 	_unique_id = id;
 }
 
@@ -210,68 +210,99 @@ bool Entity::get_draw() {
 	return _draw;
 }
 
-#define ENTITY_BYTE_SIZE sizeof(int) * 3 + sizeof(bool) * 2 + STR_PADDING * 2
+// id, type id, model id, draw, destroy -- the type, name and components follow
+#define ENTITY_HEADER_SIZE (sizeof(EntityId) + sizeof(int) * 2 + sizeof(bool) * 2)
 
-std::vector<PacketData> Entity::packet_data() {
-	std::vector<PacketData> packet;
+// length of the string at ptr with its terminator -- 0 if it isnt terminated before remaining bytes
+inline int terminated_length(const uint8_t* ptr, int remaining) {
+	const void* end = memchr(ptr, '\0', remaining);
+	return end ? (int)(static_cast<const uint8_t*>(end) - ptr) + 1 : 0;
+}
 
-	packet.push_back(std::move(PacketData(_unique_id, _id, _model_id, _draw, _destroy, _type.c_str(), _name.c_str())));
+void Entity::packet_data(PacketData& packet) {
+	packet.add(_unique_id, _id, _model_id, _draw, _destroy, _type.c_str(), _name.c_str());
 
-	for(const auto c : _components) {
-		packet.push_back(std::move(c->packet_data()));
+	for(int i = 0; i < TOTAL_COMPONENTS; ++i) {
+		if (const auto c = get(i)) {
+			packet.add(std::move(c->packet_data()));
+		}
 	}
-
-	return packet;
 }
 
 #include <iostream>
 void Entity::load_buffer(void* buf, int size) {
-	assert(size >= ENTITY_BYTE_SIZE);
+	assert(size >= (int)ENTITY_HEADER_SIZE);
+	if (size < (int)ENTITY_HEADER_SIZE) {
+		return;
+	}
 
 	uint8_t* ptr = static_cast<uint8_t*>(buf);
 	int byte = 0;
 
-	std::copy(ptr, ptr + sizeof(unsigned int), &_unique_id);
-	ptr += sizeof(unsigned int);
-	byte += sizeof(unsigned int);
+	memcpy(&_unique_id, ptr, sizeof(EntityId));
+	ptr += sizeof(EntityId);
+	byte += sizeof(EntityId);
 
-	std::copy(ptr, ptr + sizeof(int), &_id);
+	memcpy(&_id, ptr, sizeof(int));
 	ptr += sizeof(int);
 	byte += sizeof(int);
 
-	std::copy(ptr, ptr + sizeof(int), &_model_id);
+	memcpy(&_model_id, ptr, sizeof(int));
 	ptr += sizeof(int);
 	byte += sizeof(int);
 
-	std::copy(ptr, ptr + sizeof(bool), &_draw);
+	memcpy(&_draw, ptr, sizeof(bool));
 	ptr += sizeof(bool);
 	byte += sizeof(bool);
 
-	std::copy(ptr, ptr + sizeof(bool), &_destroy);
+	memcpy(&_destroy, ptr, sizeof(bool));
 	ptr += sizeof(bool);
 	byte += sizeof(bool);
 
+	int length = terminated_length(ptr, size - byte);
+	assert(length); // type runs past the buffer
+	if (!length) {
+		return;
+	}
 	_type.assign(reinterpret_cast<const char*>(ptr));
-	byte += strlen(reinterpret_cast<const char*>(ptr)) + 1;
-	ptr += strlen(reinterpret_cast<const char*>(ptr)) + 1;
+	byte += length;
+	ptr += length;
 
+	length = terminated_length(ptr, size - byte);
+	assert(length); // name runs past the buffer
+	if (!length) {
+		return;
+	}
 	_name.assign(reinterpret_cast<const char*>(ptr));
-	byte += strlen(reinterpret_cast<const char*>(ptr)) + 1;
-	ptr += strlen(reinterpret_cast<const char*>(ptr)) + 1;
+	byte += length;
+	ptr += length;
 
 	while (byte < size) {
 		const char* component = reinterpret_cast<const char*>(ptr);
-		byte += strlen(reinterpret_cast<const char*>(ptr)) + 1;
-		ptr += strlen(reinterpret_cast<const char*>(ptr)) + 1;
+		length = terminated_length(ptr, size - byte);
+		assert(length); // component name runs past the buffer
+		if (!length) {
+			return;
+		}
+		byte += length;
+		ptr += length;
 
 		if(!strcmp(component, "Transform")) {
-			if(!_components.at(TRANSFORM_COMPONENT)) {
-				_components.at(TRANSFORM_COMPONENT) = std::make_shared<TransformComponent>(shared_from_this());
+			auto transform = get<TransformComponent>();
+			if(!transform) {
+				transform = add<TransformComponent>();
+			}
+			const int component_bytes = transform->load_buffer(ptr, size - byte);
+			assert(component_bytes >= 0); // component runs past the buffer
+			if (component_bytes < 0) {
+				return;
 			}
-			byte += _components.at(TRANSFORM_COMPONENT)->load_buffer(ptr);
+			byte += component_bytes;
+			ptr += component_bytes;
 		}
 		else {
 			assert(false); // invalid buffer component data
+			return;
 		}
 
 	}
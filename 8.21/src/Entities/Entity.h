@@ -8,6 +8,7 @@
 #include <fstream>
 
 #include "../src/Network/Packet.h"
+#include "../src/Utility/SlotMap.h"
 
 #include "../src/Entities/Components/Component.h"
 #include "../src/Entities/Components/TransformComponent.h"
@@ -15,6 +16,13 @@
 constexpr const char* ENTITY_OBJECT = "Object";
 constexpr const char* ENTITY_UNIT = "Unit";
 
+// server assigned slot id -- INVALID_ENTITY_ID until the entity is added to a map
+typedef SlotId EntityId;
+#define INVALID_ENTITY_ID INVALID_SLOT
+
+// rough bytes per entity in a packet -- used to pre-size world snapshots
+#define ENTITY_PACKET_SIZE 512
+
 struct ReadEntityFile {
 	ReadEntityFile(const char* file_path, std::string_view section = "Entity");
 
@@ -46,13 +54,31 @@ public:
 	Entity(const Entity& rhs);
 	~Entity();
 
-	void add(std::shared_ptr<Component> component);
+	Entity& operator=(const Entity&) = delete;
+
+	// replaces any component of the same type
+	template<typename _Component, typename ... Args>
+	_Component* add(Args&& ... args) {
+		remove<_Component>();
+		_components[_Component::_type] = _Component::pool().create(this, std::forward<Args>(args)...);
+		return get<_Component>();
+	}
+
+	// valid until the component is removed or the entity destroyed
+	template<typename _Component>
+	_Component* get() const {
+		return _Component::pool().get(_components[_Component::_type]);
+	}
 
 	template<typename _Component>
-	std::shared_ptr<_Component> get() {
-		return std::static_pointer_cast<_Component>(_components[_Component::_type]);
+	void remove() {
+		_Component::pool().destroy(_components[_Component::_type]);
+		_components[_Component::_type] = ComponentHandle();
 	}
 
+	// by type id -- for code that walks every component
+	Component* get(int type) const;
+
 	void update();
 
 	void clear();
@@ -65,7 +91,7 @@ public:
 
 	void save(std::ofstream& file);
 
-	unsigned int get_unique_id();
+	EntityId get_unique_id();
 	int get_id();
 	std::string get_type();
 	int get_model_id();
@@ -73,15 +99,16 @@ public:
 	bool get_destroy();
 	bool get_draw();
 
-	void set_unique_id(int unique_id);
+	void set_unique_id(EntityId unique_id);
 	void set_model_id(const int model_id);
 	void set_name(const std::string_view name);
 	void set_draw(bool draw);
 
-	std::vector<PacketData> packet_data();
+	// appends the entity to packet -- read back with load_buffer()
+	void packet_data(PacketData& packet);
 	void load_buffer(void* buf, int size);
 private:
-	unsigned int _unique_id;
+	EntityId _unique_id;
 	int _id;
 	int _model_id;
 	std::string _type;
@@ -90,7 +117,7 @@ private:
 	bool _draw;
 	bool _destroy;
 
-	std::array<std::shared_ptr<Component>, TOTAL_COMPONENTS> _components{ nullptr };
+	std::array<ComponentHandle, TOTAL_COMPONENTS> _components;
 
 	friend class EntityLoader;
 };
@@ -2,31 +2,59 @@
 
 #include <iostream>
 #include <cassert>
+#include <array>
+#include <algorithm>
 
 #include "Packet.h"
+#include "PacketBuffer.h"
+#include "Replication.h"
 
 #include "../src/Entities/Entity.h"
 #include "../src/System/Environment.h"
 #include "../src/System/ResourceManager.h"
+#include "../src/Resources/Window.h"
+#include "../src/Resources/Camera.h"
+#include "../src/Resources/Terrain.h"
+#include "../src/Utility/Clock.h"
+#include "../src/Utility/Tick.h"
 
 #include "Fmtout.h"
 
 #define DEFAULT_PORT "23001"
 #define DEFAULT_HOST "192.168.1.4"
 
+// Opcode -> handler -- built at compile time
+constexpr std::array<ClientCommand, TOTAL_CLIENT_COMMANDS> make_client_commands() {
+	std::array<ClientCommand, TOTAL_CLIENT_COMMANDS> commands{};
+	commands[CLIENT_SET_ID] = &Client::set_id;
+	commands[CLIENT_LOAD_ENTITY] = &Client::load_entity;
+	commands[CLIENT_ENTITY_DELTA] = &Client::entity_delta;
+	commands[CLIENT_LOAD_WORLD] = &Client::load_world;
+	commands[CLIENT_REMOVE_ENTITIES] = &Client::remove_entities;
+	commands[CLIENT_ENTITY_CREATED] = &Client::entity_created;
+	return commands;
+}
+
+constexpr auto CLIENT_COMMANDS = make_client_commands();
+
 Client::Client() :
 	_id					( -1 ),
 	_started			( false ),
-	_connect_socket		( INVALID_SOCKET )
-{
-	load_client_commands();
-}
+	_connect_socket		( INVALID_SOCKET ),
+	_view_tile			( -1, -1 ),
+	_tick_rate			( DEFAULT_TICK_RATE ),
+	_server_tick		( 0 ),
+	_server_tick_local	( 0.0 ),
+	_render_time		( 0.0 ),
+	_interp_delay		( interpolation_load_delay() ),
+	_max_extrapolation	( interpolation_load_max_extrapolation() )
+{}
 
 Client::~Client() {
-	closesocket(_connect_socket);
+	socket_close(_connect_socket);
 
 	if (_started) {
-		WSACleanup();
+		socket_cleanup();
 		if (_recieve_thread.joinable()) {
 			_recieve_thread.detach();
 		}
@@ -34,12 +62,10 @@ Client::~Client() {
 }
 
 void Client::c_startup() {
-	int r_startup = WSAStartup(MAKEWORD(2, 2), &_wsa_data);
-	std::cout << "WsaStartup -- " << r_startup << '\n';
-	_started = true;
+	_started = socket_startup();
 
 	addrinfo* result, * ptr, hints;
-	ZeroMemory(&hints, sizeof(hints));
+	memset(&hints, 0, sizeof(hints));
 	hints.ai_family = AF_UNSPEC;
 	hints.ai_socktype = SOCK_STREAM;
 	hints.ai_protocol = IPPROTO_TCP;
@@ -50,7 +76,7 @@ void Client::c_startup() {
 	for (ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
 		_connect_socket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
 		if (_connect_socket == INVALID_SOCKET) {
-			std::cout << "Socket Error: " << WSAGetLastError() << '\n';
+			std::cout << "Socket Error: " << socket_error() << '\n';
 			continue;
 		}
 
@@ -61,23 +87,22 @@ void Client::c_startup() {
 
 	int r_connect = connect(_connect_socket, ptr->ai_addr, (int)ptr->ai_addrlen);
 	if (r_connect == SOCKET_ERROR) {
-		std::cout << "Connect Error : " << WSAGetLastError() << '\n';
+		std::cout << "Connect Error : " << socket_error() << '\n';
 	}
 	else {
+		s_hello();
 		_recieve_thread = std::thread(&Client::c_recieve, this);
 	}
 }
 
 bool Client::c_send(const char* data, int* len) {
-	assert(*len <= 1024);
-
 	int total = 0;
 	int bytes_left = *len;
 	while (total < bytes_left) {
-		int r_send = send(_connect_socket, data + total, bytes_left, 0);
+		int r_send = send(_connect_socket, data + total, bytes_left, SOCKET_SEND_FLAGS);
 		dbgout("Sending...", r_send);
 		if (r_send == SOCKET_ERROR) {
-			dbgout("Send Error --- ", WSAGetLastError());
+			dbgout("Send Error --- ", socket_error());
 			return false;
 		}
 
@@ -90,95 +115,185 @@ bool Client::c_send(const char* data, int* len) {
 	return true;
 }
 
+// Handlers are passed spans straight into the recieve buffer -- valid until they return
 void Client::c_recieve() {
-	char recvbuf[2048];
-	char* ptr;
+	PacketBuffer recvbuf;
 	int r_recv = -1;
-	int recvbuflen = 1024;
-	int bytes_handled = 0;
-	int remaining_bytes = 0;
-	int packet_length = 0;
 
 	do {
-		bytes_handled = 0;
-		r_recv = recv(_connect_socket, recvbuf + remaining_bytes, recvbuflen, 0);
+		r_recv = recv(_connect_socket, recvbuf.write_ptr(), recvbuf.write_space(), 0);
 		if (r_recv > 0) {
 			dbgout("Receiving...", r_recv);
-			ptr = recvbuf;
-			remaining_bytes = r_recv + remaining_bytes;
-
-			if (remaining_bytes >= 4) {
-				memcpy(&packet_length, ptr, sizeof(int));
-
-				while (remaining_bytes >= packet_length) {
-					dbgout("Command --- ", ptr + 4); // command
-
-					const char* key = ptr + 4; // skip int header
-					int command_length = strlen(ptr + 4) + 1;
-					if (_client_commands.find(key) == _client_commands.end()) {
-						dbgout("Unknown Client Command --- ", key);
-					}
-					else {
-						(this->*_client_commands.at(ptr + 4))(static_cast<void*>(ptr + command_length + 4), packet_length - command_length - 4);
-					}
-
-					bytes_handled += packet_length;
-					remaining_bytes -= packet_length;
-
-					if (remaining_bytes >= 4) {
-						ptr = recvbuf + bytes_handled;
-						memcpy(&packet_length, ptr, sizeof(int));
-					}
+			recvbuf.commit(r_recv);
+
+			char* ptr = nullptr;
+			int packet_length = 0;
+			while ((packet_length = recvbuf.next_packet(&ptr)) > 0) {
+				const Opcode opcode = ptr[sizeof(int)];
+				dbgout("Command --- ", (int)opcode);
+
+				if (opcode >= TOTAL_CLIENT_COMMANDS) {
+					dbgout("Unknown Client Command --- ", (int)opcode);
+				}
+				else {
+					(this->*CLIENT_COMMANDS[opcode])(static_cast<void*>(ptr + PACKET_HEADER_SIZE), packet_length - PACKET_HEADER_SIZE);
 				}
 
+				recvbuf.consume(packet_length);
 			}
 
-			if (remaining_bytes > 0) {
-				memcpy(recvbuf, ptr, remaining_bytes);
+			if (packet_length == PACKET_INVALID) {
+				fmtout("Invalid Packet --- Closing Connection");
+				break;
 			}
 		}
 		else if (r_recv == 0) {
 			fmtout("Close Connection");
 		}
 		else {
-			fmtout("Recv Error --- ", WSAGetLastError());
+			fmtout("Recv Error --- ", socket_error());
 		}
 	} while (r_recv > 0);
 
 }
 
+// Render time trails the server by _interp_delay so there is usually a snapshot either side of it
+void Client::c_interpolate() {
+	std::lock_guard<std::mutex> lock(_replicated_mutex);
+
+	if (_server_tick == 0) {
+		return;
+	}
+
+	const double now = server_time(_server_tick) + (clock_seconds() - _server_tick_local);
+	_render_time = std::max(_render_time, now - _interp_delay);
+
+	const double confirmed_time = server_time(_server_tick);
+	const float range = replication_range();
+	const auto terrain = Environment::get().get_resource_manager()->get_terrain_data();
+
+	for (auto& r : _replicated) {
+		// destinations take the newest state -- positions wait for their snapshot below
+		r.transform->_destination = state_destination(r.state, range, terrain.get());
+		r.transform->_dest_reached = (r.state.flags & STATE_DEST_REACHED) != 0;
+
+		glm::vec3 position;
+		float yaw;
+		if (!r.snapshots.sample(_render_time, confirmed_time, _max_extrapolation, &position, &yaw)) {
+			continue;
+		}
+
+		r.transform->set(position);
+
+		glm::vec3 rotation = r.transform->_transform.get_rotation();
+		rotation.y = yaw;
+		r.transform->_transform.set_rotation(rotation);
+	}
+}
+
 bool Client::c_connected() {
 	return _connect_socket == INVALID_SOCKET;
 }
 
+// Sent before anything else -- the server answers with set_id
+void Client::s_hello() {
+	PacketData packet(SERVER_HELLO, PROTOCOL_VERSION);
+	int len = packet.length();
+
+	c_send(packet.c_str(), &len);
+}
+
 void Client::s_load_world_server() {
-	PacketData packet("load_world_server", _id);
+	PacketData packet(SERVER_LOAD_WORLD, _id);
 	int len = packet.length();
 
 	c_send(packet.c_str(), &len);
 }
 
+// the server answers with entity_created()
 void Client::s_new_entity(std::shared_ptr<Entity> entity) {
-	PacketData packet("new_entity", _id);
+	_replicated_mutex.lock();
+	const SlotId local_id = _local_entities.insert({ entity });
+	_replicated_mutex.unlock();
 
-	auto packet_vector = entity->packet_data();
-	for(auto& p : packet_vector) {
-		packet.add(std::move(p));
+	PacketData packet(SERVER_NEW_ENTITY, _id, local_id);
+	entity->packet_data(packet);
+
+	int len = packet.length();
+	c_send(packet.c_str(), &len);
+}
+
+void Client::s_group_move(const std::vector<SlotId>& ids, glm::vec3 destination) {
+	if (ids.empty()) {
+		return;
+	}
+
+	PacketData packet(SERVER_GROUP_MOVE, _id, destination, (int)ids.size());
+	packet.reserve(packet.length() + (int)(ids.size() * sizeof(SlotId)));
+	for (const auto id : ids) {
+		packet.add(id);
 	}
 
 	int len = packet.length();
 	c_send(packet.c_str(), &len);
 }
 
-void Client::load_client_commands() {
-	_client_commands.emplace("set_id", &Client::set_id);
-	_client_commands.emplace("load_entity", &Client::load_entity);
-	_client_commands.emplace("set_destination", &Client::set_destination);
+// Sends where the camera looks at the ground -- only when it moves onto another tile
+void Client::s_set_view() {
+	if (_id == -1) {
+		return;
+	}
+
+	const auto camera = Environment::get().get_window()->get_camera();
+	const glm::vec3 position = camera->get_position();
+	const glm::vec3 direction = camera->get_direction();
+
+	glm::vec3 focus = position;
+	if (direction.y < 0.0f) {
+		focus = position + direction * (-position.y / direction.y);
+	}
+
+	const auto terrain = Environment::get().get_resource_manager()->get_terrain_data();
+	if (terrain) {
+		focus.x /= terrain->get_tile_width();
+		focus.z /= terrain->get_tile_length();
+	}
+
+	const glm::ivec2 tile((int)focus.x, (int)focus.z);
+	if (tile == _view_tile) {
+		return;
+	}
+	_view_tile = tile;
+
+	if (terrain) {
+		focus.x *= terrain->get_tile_width();
+		focus.z *= terrain->get_tile_length();
+	}
+
+	PacketData packet(SERVER_SET_VIEW, _id, focus);
+	int len = packet.length();
+
+	c_send(packet.c_str(), &len);
 }
 
+// Params: int client_id, int version, int tick_rate
 void Client::set_id(void* buf, int size) {
-	assert(size == sizeof(int));
+	assert(size == sizeof(int) * 3);
+
+	int version;
+	memcpy(&version, static_cast<char*>(buf) + sizeof(int), sizeof(int));
+	if (version != PROTOCOL_VERSION) {
+		fmtout("Protocol Version Mismatch --- ", version, "Expected --- ", PROTOCOL_VERSION);
+	}
 
+	int tick_rate;
+	memcpy(&tick_rate, static_cast<char*>(buf) + sizeof(int) * 2, sizeof(int));
+
+	_replicated_mutex.lock();
+	_tick_rate = tick_rate > 0 ? tick_rate : DEFAULT_TICK_RATE;
+	_replicated_mutex.unlock();
+
+	// set last -- the engine waits on it
 	memcpy(&_id, buf, sizeof(int));
 }
 
@@ -190,31 +305,181 @@ void Client::load_entity(void* buf, int size) {
 	entity->load_buffer(buf, size);
 
 	std::cout << "UNIQUE ID" << entity->get_unique_id() << '\n';
-	
+
+	_replicated_mutex.lock();
+	add_replicated(entity);
+	_replicated_mutex.unlock();
+
 	Environment::get().get_resource_manager()->add_entity(entity);
 }
 
-void Client::set_destination(void* buf, int size) {
-	int entity_id;
-	memcpy(&entity_id, buf, sizeof(int));
-
+// Params: int count, (int size, Entity) * count
+// builds every entity first then adds them all under one lock
+void Client::load_world(void* buf, int size) {
 	char* ptr = static_cast<char*>(buf);
-	ptr = ptr + 4;
+	char* end = ptr + size;
+
+	int count;
+	memcpy(&count, ptr, sizeof(int));
+	ptr += sizeof(int);
+
+	std::vector<std::shared_ptr<Entity>> entities;
+	entities.reserve(count);
+
+	for (int i = 0; i < count && ptr + sizeof(int) <= end; ++i) {
+		int entity_size;
+		memcpy(&entity_size, ptr, sizeof(int));
+		ptr += sizeof(int);
+
+		if (entity_size <= 0 || ptr + entity_size > end) {
+			fmtout("Invalid World Packet --- ", i, "/", count);
+			break;
+		}
+
+		std::shared_ptr<Entity> entity = std::make_shared<Entity>();
+		entity->load_buffer(ptr, entity_size);
+		entities.push_back(entity);
+
+		ptr += entity_size;
+	}
+
+	fmtout("Load World --- ", entities.size(), "Entities");
+
+	_replicated_mutex.lock();
+	for (const auto& entity : entities) {
+		add_replicated(entity);
+	}
+	_replicated_mutex.unlock();
+
+	Environment::get().get_resource_manager()->add_entities(entities);
+}
+
+// Params: unsigned int tick, int count, (unsigned int entity_id, delta) * count
+// only updates the replicated state and snapshots -- c_interpolate() applies them to the transforms
+void Client::entity_delta(void* buf, int size) {
+	if (size < (int)(sizeof(unsigned int) + sizeof(int))) {
+		fmtout("Invalid Delta Packet --- ", size, "Bytes");
+		return;
+	}
+
+	const char* ptr = static_cast<const char*>(buf);
+	const char* end = ptr + size;
+
+	unsigned int tick;
+	memcpy(&tick, ptr, sizeof(unsigned int));
+	ptr += sizeof(unsigned int);
+
+	int count;
+	memcpy(&count, ptr, sizeof(int));
+	ptr += sizeof(int);
+
+	// every entity is at least its id and a mask byte
+	if (count < 0 || (size_t)count > (size_t)(end - ptr) / (sizeof(unsigned int) + sizeof(uint8_t))) {
+		fmtout("Invalid Delta Packet --- ", count, "Entities");
+		return;
+	}
+
+	const float range = replication_range();
+
+	std::lock_guard<std::mutex> lock(_replicated_mutex);
+
+	_server_tick = tick;
+	_server_tick_local = clock_seconds();
+
+	const double time = server_time(tick);
+	const double step = 1.0 / _tick_rate;
 
-	glm::vec3 destination;
-	memcpy(&destination, ptr, sizeof(glm::vec3));
+	for (int i = 0; i < count && ptr + sizeof(unsigned int) <= end; ++i) {
+		unsigned int entity_id;
+		memcpy(&entity_id, ptr, sizeof(unsigned int));
+		ptr += sizeof(unsigned int);
 
-	auto entities = Environment::get().get_resource_manager()->get_entities();
+		ReplicatedEntity* replicated = _replicated.get(entity_id);
 
-	if(!entities->count(entity_id)) {
-		assert(NULL);
+		const int bytes = read_delta(ptr, end - ptr, replicated ? &replicated->state : nullptr);
+		if (bytes < 0) {
+			fmtout("Invalid Delta Packet --- ", i, "/", count);
+			return;
+		}
+		ptr += bytes;
+
+		if (!replicated) {
+			continue;
+		}
+
+		const EntityState& state = replicated->state;
+		replicated->snapshots.push(time, step, state_position(state, range), dequantize_yaw(state.yaw));
+	}
+}
+
+// Params: int count, unsigned int entity_id * count
+// entities that left this client's area of interest
+void Client::remove_entities(void* buf, int size) {
+	const char* ptr = static_cast<const char*>(buf);
+
+	int count;
+	memcpy(&count, ptr, sizeof(int));
+	ptr += sizeof(int);
+
+	if (count < 0 || size < (int)(sizeof(int) + count * sizeof(unsigned int))) {
+		fmtout("Invalid Remove Packet --- ", count);
+		return;
+	}
+
+	std::vector<unsigned int> ids(count);
+	memcpy(ids.data(), ptr, count * sizeof(unsigned int));
+
+	_replicated_mutex.lock();
+	for (const auto id : ids) {
+		_replicated.erase(id);
 	}
+	_replicated_mutex.unlock();
 
-	entities->at(entity_id)->get<TransformComponent>()->set_destination(destination);
+	Environment::get().get_resource_manager()->remove_entities(ids);
+}
+
+// Params: EntityId local_id, EntityId entity_id
+// the server's copy is replicated back as entity_id -- the local one isnt needed anymore
+void Client::entity_created(void* buf, int size) {
+	if (size != sizeof(SlotId) * 2) {
+		return;
+	}
+
+	SlotId local_id;
+	memcpy(&local_id, buf, sizeof(SlotId));
+
+	std::lock_guard<std::mutex> lock(_replicated_mutex);
+	_local_entities.erase(local_id);
 }
 
 int Client::get_id() {
 	return _id;
 }
 
+// _replicated_mutex must be held
+// the first snapshot is where the server had it when it was sent -- the tick after the newest recieved
+void Client::add_replicated(std::shared_ptr<Entity> entity) {
+	const auto transform = entity->get<TransformComponent>();
+	if (!transform) {
+		return;
+	}
+
+	ReplicatedEntity* existing = _replicated.get(entity->get_unique_id());
+	if (!existing) {
+		_replicated.insert_at(entity->get_unique_id(), ReplicatedEntity());
+		existing = _replicated.get(entity->get_unique_id());
+	}
+
+	ReplicatedEntity& replicated = *existing;
+	replicated.entity = entity;
+	replicated.transform = transform;
+	replicated.state = make_entity_state(*transform, replication_range());
+	replicated.snapshots.clear();
+	replicated.snapshots.push(server_time(_server_tick + 1), 1.0 / _tick_rate, transform->_transform.get_position(), transform->_transform.get_rotation().y);
+}
+
+double Client::server_time(unsigned int tick) {
+	return (double)tick / _tick_rate;
+}
+
 /********************************************************************************************************************************************************/
\ No newline at end of file
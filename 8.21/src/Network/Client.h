@@ -1,21 +1,39 @@
 #ifndef CLIENT_H
 #define CLIENT_H
 
-#include <WinSock2.h>
-#include <ws2tcpip.h>
-
-#pragma comment(lib, "Ws2_32.lib")
-
 #include <thread>
-#include <unordered_map>
+#include <mutex>
+#include <memory>
 #include <string>
 #include <string_view>
 
+#include <glm/glm.hpp>
+
+#include "Socket.h"
+#include "Replication.h"
+#include "Interpolation.h"
+
+#include "../src/Utility/SlotMap.h"
+
 class Client;
 class Entity;
+class TransformComponent;
 
 typedef void(Client::*ClientCommand)(void* buf, int size);
 
+// client copy of an entity the server replicates to it
+struct ReplicatedEntity {
+	std::shared_ptr<Entity> entity;
+	TransformComponent* transform = nullptr;
+	EntityState state;
+	SnapshotBuffer snapshots;
+};
+
+// entity this client asked the server for -- kept until the server answers
+struct LocalEntity {
+	std::shared_ptr<Entity> entity;
+};
+
 class Client {
 public:
 	Client();
@@ -27,26 +45,58 @@ public:
 	bool c_connected();
 	void c_read(uint8_t* data);
 
-	void load_client_commands();
+	// main thread -- moves replicated entities to where they were _interp_delay ago
+	void c_interpolate();
 
+	void s_hello();
 	void s_load_world_server();
 	void s_new_entity(std::shared_ptr<Entity> entity);
+	void s_set_view();
+	// one packet for every unit sent to destination
+	void s_group_move(const std::vector<SlotId>& ids, glm::vec3 destination);
 
 	void set_id(void* buf, int size);
 	void load_entity(void* buf, int size);
-	void set_destination(void* buf, int size);
+	void load_world(void* buf, int size);
+	void entity_delta(void* buf, int size);
+	void remove_entities(void* buf, int size);
+	void entity_created(void* buf, int size);
 
 	int get_id();
+private:
+	void add_replicated(std::shared_ptr<Entity> entity);
+	double server_time(unsigned int tick);
 private:
 	int _id;
 	bool _started;
 
-	WSAData _wsa_data;
-	SOCKET _connect_socket;
+	socket_t _connect_socket;
+
+	// tile under the camera focus last sent to the server
+	glm::ivec2 _view_tile;
 
 	std::thread _recieve_thread;
 
-	std::unordered_map<std::string, ClientCommand> _client_commands;
+	// guards everything below -- written on the recieve thread, read by c_interpolate()
+	std::mutex _replicated_mutex;
+
+	// mirrors the server's entity ids
+	SlotMap<ReplicatedEntity> _replicated;
+
+	// ids this client gives the entities it sends with s_new_entity() -- erased by entity_created()
+	SlotMap<LocalEntity> _local_entities;
+
+	int _tick_rate;
+
+	// newest tick recieved and the clock_seconds() it arrived at
+	unsigned int _server_tick;
+	double _server_tick_local;
+
+	// never goes backwards
+	double _render_time;
+
+	float _interp_delay;
+	float _max_extrapolation;
 };
 
 /********************************************************************************************************************************************************/
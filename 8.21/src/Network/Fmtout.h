@@ -1,7 +1,10 @@
 #ifndef FMTOUT_H
 #define FMTOUT_H
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
+#include <iostream>
 #include <mutex>
 
 #include "../src/System/Environment.h"
@@ -29,14 +32,18 @@ template <typename ... Args>
 void fmtout(Args ... args) {
 	std::lock_guard<std::mutex> lock(fmt_mutex());
 
+#ifdef _WIN32
 	static const HANDLE hstdout = GetStdHandle(STD_OUTPUT_HANDLE);
 
 	SetConsoleTextAttribute(hstdout, FOREGROUND_BLUE | FOREGROUND_GREEN);
+#endif
 
 	std::cout << "[" << Environment::get().get_clock()->get_system_time() << "]["
 		<< Environment::get().get_clock()->get_display_time() << "] ";
 
+#ifdef _WIN32
 	SetConsoleTextAttribute(hstdout, FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_GREEN);
+#endif
 
 	_out(args...);
 	std::cout << '\n';
@@ -0,0 +1,108 @@
+#include "Interest.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "../src/Resources/Terrain.h"
+
+InterestGrid::InterestGrid() :
+	_width			( 1 ),
+	_length			( 1 ),
+	_cell_width		( 1.0f ),
+	_cell_length	( 1.0f )
+{
+	_cells.resize(1);
+}
+
+void InterestGrid::resize(TerrainData* terrain) {
+	_cells.clear();
+	_entity_cells.clear();
+
+	if (!terrain) {
+		_width = 1;
+		_length = 1;
+		_cells.resize(1);
+		return;
+	}
+
+	_cell_width = terrain->get_tile_width() * INTEREST_CELL_TILES;
+	_cell_length = terrain->get_tile_length() * INTEREST_CELL_TILES;
+
+	_width = std::max(1, (terrain->get_width() + INTEREST_CELL_TILES - 1) / INTEREST_CELL_TILES);
+	_length = std::max(1, (terrain->get_length() + INTEREST_CELL_TILES - 1) / INTEREST_CELL_TILES);
+
+	_cells.resize(_width * _length);
+}
+
+void InterestGrid::update(unsigned int id, glm::vec3 position) {
+	const glm::ivec2 cell = get_cell(position);
+	const int index = cell.y * _width + cell.x;
+
+	if (const auto cell_index = _entity_cells.get(id)) {
+		if (*cell_index == index) {
+			return;
+		}
+
+		auto& old_cell = _cells[*cell_index];
+		const auto e = std::find(old_cell.begin(), old_cell.end(), id);
+		if (e != old_cell.end()) {
+			*e = old_cell.back();
+			old_cell.pop_back();
+		}
+		*cell_index = index;
+	}
+	else {
+		_entity_cells.insert_at(id, index);
+	}
+
+	_cells[index].push_back(id);
+}
+
+void InterestGrid::remove(unsigned int id) {
+	const auto cell_index = _entity_cells.get(id);
+	if (!cell_index) {
+		return;
+	}
+
+	auto& cell = _cells[*cell_index];
+	const auto e = std::find(cell.begin(), cell.end(), id);
+	if (e != cell.end()) {
+		*e = cell.back();
+		cell.pop_back();
+	}
+
+	_entity_cells.erase(id);
+}
+
+glm::ivec2 InterestGrid::get_cell(glm::vec3 position) {
+	const int x = (int)(position.x / _cell_width);
+	const int z = (int)(position.z / _cell_length);
+
+	return glm::ivec2(std::clamp(x, 0, _width - 1), std::clamp(z, 0, _length - 1));
+}
+
+void InterestGrid::query(glm::ivec2 center, int radius, std::vector<unsigned int>& ids) {
+	const int min_x = std::max(0, center.x - radius);
+	const int max_x = std::min(_width - 1, center.x + radius);
+	const int min_z = std::max(0, center.y - radius);
+	const int max_z = std::min(_length - 1, center.y + radius);
+
+	for (int z = min_z; z <= max_z; ++z) {
+		for (int x = min_x; x <= max_x; ++x) {
+			const auto& cell = _cells[z * _width + x];
+			ids.insert(ids.end(), cell.begin(), cell.end());
+		}
+	}
+}
+
+bool InterestGrid::in_range(unsigned int id, glm::ivec2 center, int radius) {
+	const auto cell_index = _entity_cells.get(id);
+	if (!cell_index) {
+		return false;
+	}
+
+	const int x = *cell_index % _width;
+	const int z = *cell_index / _width;
+
+	return std::abs(x - center.x) <= radius && std::abs(z - center.y) <= radius;
+}
@@ -0,0 +1,51 @@
+#ifndef INTEREST_H
+#define INTEREST_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../src/Utility/SlotMap.h"
+
+// terrain tiles per side of an interest cell
+#define INTEREST_CELL_TILES 8
+
+// cells around a client's view it is sent
+// entities stay until they are INTEREST_RADIUS + 1 cells away so they dont flicker on a cell edge
+#define INTEREST_RADIUS 3
+
+class TerrainData;
+
+// Server area of interest -- the map split into square blocks of terrain tiles
+// each entity is in one cell, each client sees the cells around its camera
+class InterestGrid {
+public:
+	InterestGrid();
+
+	void resize(TerrainData* terrain);
+
+	// moves the entity between cells only when its cell changes
+	void update(unsigned int id, glm::vec3 position);
+	void remove(unsigned int id);
+
+	// cell x / z of a world position -- clamped to the map
+	glm::ivec2 get_cell(glm::vec3 position);
+
+	// adds every entity within radius cells of center
+	void query(glm::ivec2 center, int radius, std::vector<unsigned int>& ids);
+
+	// true if the entity is within radius cells of center
+	bool in_range(unsigned int id, glm::ivec2 center, int radius);
+private:
+	int _width;
+	int _length;
+	float _cell_width;
+	float _cell_length;
+
+	std::vector<std::vector<unsigned int>> _cells;
+
+	// entity id -> index into _cells
+	SlotMap<int> _entity_cells;
+};
+
+#endif
@@ -0,0 +1,131 @@
+#include "Interpolation.h"
+
+#include "../src/Utility/FileReader.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define FILE_INTERP_DELAY "f_interp_delay"
+#define FILE_MAX_EXTRAPOLATION "f_max_extrapolation"
+
+float interpolation_load_delay(const char* file_path) {
+	FileReader file(file_path);
+
+	float delay = DEFAULT_INTERP_DELAY;
+	file.s_read(&delay, FILE_INTERP_DELAY, "System");
+
+	return delay >= 0.0f ? delay : DEFAULT_INTERP_DELAY;
+}
+
+float interpolation_load_max_extrapolation(const char* file_path) {
+	FileReader file(file_path);
+
+	float max_extrapolation = DEFAULT_MAX_EXTRAPOLATION;
+	file.s_read(&max_extrapolation, FILE_MAX_EXTRAPOLATION, "System");
+
+	return max_extrapolation >= 0.0f ? max_extrapolation : DEFAULT_MAX_EXTRAPOLATION;
+}
+
+// shortest way round -- degrees
+float lerp_yaw(float a, float b, float t) {
+	float d = std::fmod(b - a, 360.0f);
+	if (d > 180.0f) {
+		d -= 360.0f;
+	}
+	else if (d < -180.0f) {
+		d += 360.0f;
+	}
+
+	float yaw = a + d * t;
+	if (yaw < 0.0f) {
+		yaw += 360.0f;
+	}
+	else if (yaw >= 360.0f) {
+		yaw -= 360.0f;
+	}
+	return yaw;
+}
+
+/********************************************************************************************************************************************************/
+
+SnapshotBuffer::SnapshotBuffer() :
+	_first			( 0 ),
+	_count			( 0 )
+{}
+
+void SnapshotBuffer::push(double time, double step, glm::vec3 position, float yaw) {
+	if (_count > 0) {
+		const Snapshot last = at(_count - 1);
+		if (time <= last.time) {
+			return;
+		}
+
+		if (time - last.time > step * 1.5) {
+			push(time - step, step, last.position, last.yaw);
+		}
+	}
+
+	if (_count == SNAPSHOT_BUFFER_SIZE) {
+		_first = (_first + 1) % SNAPSHOT_BUFFER_SIZE;
+		--_count;
+	}
+
+	Snapshot& snapshot = at(_count);
+	snapshot.time = time;
+	snapshot.position = position;
+	snapshot.yaw = yaw;
+	++_count;
+}
+
+bool SnapshotBuffer::sample(double render_time, double confirmed_time, double max_extrapolation, glm::vec3* position, float* yaw) {
+	if (_count == 0) {
+		return false;
+	}
+
+	// keep one snapshot at or before render_time to interpolate from
+	// and always the newest two for the velocity to extrapolate with
+	while (_count > 2 && at(1).time <= render_time) {
+		_first = (_first + 1) % SNAPSHOT_BUFFER_SIZE;
+		--_count;
+	}
+
+	const Snapshot& first = at(0);
+	if (_count == 1 || render_time <= first.time) {
+		*position = first.position;
+		*yaw = first.yaw;
+		return true;
+	}
+
+	const Snapshot& next = at(1);
+	if (render_time < next.time) {
+		const float t = (float)((render_time - first.time) / (next.time - first.time));
+		*position = glm::mix(first.position, next.position, t);
+		*yaw = lerp_yaw(first.yaw, next.yaw, t);
+		return true;
+	}
+
+	// past the newest snapshot
+	*position = next.position;
+	*yaw = next.yaw;
+
+	if (next.time >= confirmed_time) {
+		const double dt = std::min(render_time - next.time, max_extrapolation);
+		const glm::vec3 velocity = (next.position - first.position) / (float)(next.time - first.time);
+		*position += velocity * (float)dt;
+	}
+
+	return true;
+}
+
+void SnapshotBuffer::clear() {
+	_first = 0;
+	_count = 0;
+}
+
+bool SnapshotBuffer::empty() {
+	return _count == 0;
+}
+
+Snapshot& SnapshotBuffer::at(int i) {
+	return _snapshots[(_first + i) % SNAPSHOT_BUFFER_SIZE];
+}
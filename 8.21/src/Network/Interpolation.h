@@ -0,0 +1,51 @@
+#ifndef INTERPOLATION_H
+#define INTERPOLATION_H
+
+#include <glm/glm.hpp>
+
+#define INTERPOLATION_FILE "Data/system.txt"
+
+// seconds the client renders behind the server
+#define DEFAULT_INTERP_DELAY 0.1f
+
+// longest the client keeps moving an entity past its newest snapshot
+#define DEFAULT_MAX_EXTRAPOLATION 0.25f
+
+#define SNAPSHOT_BUFFER_SIZE 16
+
+float interpolation_load_delay(const char* file_path = INTERPOLATION_FILE);
+float interpolation_load_max_extrapolation(const char* file_path = INTERPOLATION_FILE);
+
+// server time is the server tick / tick rate
+struct Snapshot {
+	double time = 0.0;
+	glm::vec3 position = glm::vec3(0.0f);
+	float yaw = 0.0f;
+};
+
+// Timestamped transforms of one replicated entity -- oldest first
+class SnapshotBuffer {
+public:
+	SnapshotBuffer();
+
+	// step is the server tick length -- a gap of more than one tick means the entity
+	// didnt move for it so the last snapshot is repeated at the tick before time
+	void push(double time, double step, glm::vec3 position, float yaw);
+
+	// interpolates at render_time, drops snapshots older than it
+	// confirmed_time is the newest server tick recieved -- an entity with no snapshot
+	// since then stood still so it is only extrapolated if it moved in the newest tick
+	// returns false if there are no snapshots
+	bool sample(double render_time, double confirmed_time, double max_extrapolation, glm::vec3* position, float* yaw);
+
+	void clear();
+	bool empty();
+private:
+	Snapshot& at(int i);
+
+	Snapshot _snapshots[SNAPSHOT_BUFFER_SIZE];
+	int _first;
+	int _count;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef OPCODE_H
+#define OPCODE_H
+
+#include <cstdint>
+
+// bump whenever a message id or layout changes
+#define PROTOCOL_VERSION 8
+
+// Packet -- int length, Opcode, data
+typedef uint8_t Opcode;
+
+// constants rather than an enum so PacketData(opcode, ...) picks the Opcode overload
+
+// client -> server
+constexpr Opcode SERVER_HELLO			= 0;	// int version -- must be the first packet
+constexpr Opcode SERVER_LOAD_WORLD		= 1;	// int client_id
+constexpr Opcode SERVER_NEW_ENTITY		= 2;	// int client_id, EntityId local_id, Entity
+constexpr Opcode SERVER_SET_DESTINATION	= 3;	// int client_id, EntityId entity_id, vec3 destination
+constexpr Opcode SERVER_SET_VIEW		= 4;	// int client_id, vec3 focus
+constexpr Opcode SERVER_GROUP_MOVE		= 5;	// int client_id, vec3 destination, int count, EntityId entity_id * count
+constexpr Opcode TOTAL_SERVER_COMMANDS	= 6;
+
+// server -> client
+constexpr Opcode CLIENT_SET_ID			= 0;	// int client_id, int version, int tick_rate
+constexpr Opcode CLIENT_LOAD_ENTITY		= 1;	// Entity
+constexpr Opcode CLIENT_ENTITY_DELTA	= 2;	// unsigned int tick, int count, (unsigned int entity_id, delta) * count
+constexpr Opcode CLIENT_LOAD_WORLD		= 3;	// int count, (int size, Entity) * count
+constexpr Opcode CLIENT_REMOVE_ENTITIES	= 4;	// int count, unsigned int entity_id * count
+constexpr Opcode CLIENT_ENTITY_CREATED	= 5;	// EntityId local_id, EntityId entity_id
+constexpr Opcode TOTAL_CLIENT_COMMANDS	= 6;
+
+#endif
@@ -3,12 +3,11 @@
 #include <cassert>
 #include <iterator>
 
-PacketData::PacketData(const char* key) {
-	_data.resize(4);
-	int header = 4;
+PacketData::PacketData(Opcode opcode) {
+	_data.resize(PACKET_HEADER_SIZE);
+	int header = PACKET_HEADER_SIZE;
 	memcpy(&_data[0], &header, sizeof(int));
-
-	add(key);
+	_data[sizeof(int)] = opcode;
 }
 
 PacketData::PacketData(PacketData&& rhs) noexcept :
@@ -67,6 +66,15 @@ void PacketData::add(PacketData&& rhs) {
 	memcpy(&_data[0], &size, sizeof(int));
 }
 
+void PacketData::set(int offset, int data) {
+	assert(offset >= 0 && offset + (int)sizeof(int) <= (int)_data.size());
+	memcpy(&_data[offset], &data, sizeof(int));
+}
+
+void PacketData::reserve(int size) {
+	_data.reserve(size);
+}
+
 int PacketData::length() {
 	return _data.size();
 }
@@ -3,14 +3,24 @@
 
 #include <vector>
 #include <string_view>
+#include <cstring>
+#include <iterator>
+
+#include "Opcode.h"
 
 #define STR_PADDING 54
 
+// int length + Opcode
+#define PACKET_HEADER_SIZE (int)(sizeof(int) + sizeof(Opcode))
+
 class PacketData {
 public:
-	PacketData(const char* key);
+	PacketData(Opcode opcode);
 	PacketData(PacketData&& rhs) noexcept;
 
+	template<typename ... Args>
+	PacketData(Opcode opcode, Args ... args);
+
 	template<typename ... Args>
 	PacketData(Args ... args);
 
@@ -28,12 +38,23 @@ public:
 
 	void add(PacketData&& rhs);
 
+	// overwrites an int already in the packet -- for sizes only known after writing
+	void set(int offset, int data);
+	void reserve(int size);
+
 	const char* c_str();
 	int length();
 private:
 	std::vector<uint8_t> _data;
 };
 
+template<typename ... Args>
+PacketData::PacketData(Opcode opcode, Args ... args) :
+	PacketData(opcode)
+{
+	add(args...);
+}
+
 template<typename ... Args>
 PacketData::PacketData(Args ... args)
 {
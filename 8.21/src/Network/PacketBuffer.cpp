@@ -0,0 +1,90 @@
+#include "PacketBuffer.h"
+
+#include <cstring>
+#include <cassert>
+
+#define PACKET_LENGTH_SIZE (int)sizeof(int)
+
+PacketBuffer::PacketBuffer(int capacity) :
+	_data			( capacity ),
+	_read			( 0 ),
+	_write			( 0 )
+{}
+
+char* PacketBuffer::write_ptr() {
+	if (_write == (int)_data.size()) {
+		reserve(size() + 1);
+	}
+	return _data.data() + _write;
+}
+
+int PacketBuffer::write_space() {
+	return _data.size() - _write;
+}
+
+void PacketBuffer::commit(int bytes) {
+	assert(bytes <= write_space());
+	_write += bytes;
+}
+
+int PacketBuffer::next_packet(char** packet) {
+	if (size() < PACKET_LENGTH_SIZE) {
+		return PACKET_INCOMPLETE;
+	}
+
+	int length;
+	memcpy(&length, _data.data() + _read, sizeof(int));
+	if (length <= PACKET_LENGTH_SIZE || length > PACKET_MAX_LENGTH) {
+		return PACKET_INVALID;
+	}
+
+	if (size() < length) {
+		// make room for the rest so the next recv() can finish it
+		reserve(length);
+		return PACKET_INCOMPLETE;
+	}
+
+	*packet = _data.data() + _read;
+	return length;
+}
+
+void PacketBuffer::consume(int bytes) {
+	assert(bytes <= size());
+	_read += bytes;
+
+	// empty -- start over at the front for free
+	if (_read == _write) {
+		_read = 0;
+		_write = 0;
+	}
+}
+
+int PacketBuffer::size() {
+	return _write - _read;
+}
+
+int PacketBuffer::capacity() {
+	return _data.size();
+}
+
+// makes sure bytes of unread data fit without running off the end
+void PacketBuffer::reserve(int bytes) {
+	if (_read + bytes <= (int)_data.size() && _write < (int)_data.size()) {
+		return;
+	}
+
+	const int unread = size();
+	if (_read > 0) {
+		memmove(_data.data(), _data.data() + _read, unread);
+		_read = 0;
+		_write = unread;
+	}
+
+	if (bytes >= (int)_data.size() || _write == (int)_data.size()) {
+		size_t capacity = _data.size();
+		while (capacity <= (size_t)bytes) {
+			capacity *= 2;
+		}
+		_data.resize(capacity);
+	}
+}
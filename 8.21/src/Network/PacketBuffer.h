@@ -0,0 +1,40 @@
+#ifndef PACKET_BUFFER_H
+#define PACKET_BUFFER_H
+
+#include <vector>
+
+#define PACKET_BUFFER_SIZE 4096
+// anything bigger is treated as a corrupt stream
+#define PACKET_MAX_LENGTH (64 * 1024 * 1024)
+
+#define PACKET_INCOMPLETE 0
+#define PACKET_INVALID -1
+
+// Per connection recieve buffer
+// recv() writes straight into the free space and complete packets are read in place
+// grows to fit whatever packet is next -- unread bytes only move once the end of the buffer is reached
+class PacketBuffer {
+public:
+	PacketBuffer(int capacity = PACKET_BUFFER_SIZE);
+
+	// free space to recv() into -- never empty
+	char* write_ptr();
+	int write_space();
+	void commit(int bytes);
+
+	// returns the length of the next packet (header included) and points packet at it
+	// PACKET_INCOMPLETE until all of it has arrived -- PACKET_INVALID on a bad header
+	int next_packet(char** packet);
+	void consume(int bytes);
+
+	int size();
+	int capacity();
+private:
+	void reserve(int bytes);
+
+	std::vector<char> _data;
+	int _read;
+	int _write;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "Poller.h"
+
+#include <cassert>
+#include <algorithm>
+
+#define POLLER_MAX_EVENTS 256
+
+#ifdef __linux__
+
+Poller::Poller() :
+	_epoll			( epoll_create1(0) ),
+	_events			( POLLER_MAX_EVENTS )
+{
+	assert(_epoll != -1);
+}
+
+Poller::~Poller() {
+	close(_epoll);
+}
+
+bool Poller::add(socket_t socket) {
+	epoll_event event = {};
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.fd = socket;
+	return epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+void Poller::remove(socket_t socket) {
+	epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+bool Poller::set_write(socket_t socket, bool write) {
+	epoll_event event = {};
+	event.events = EPOLLIN | EPOLLRDHUP | (write ? (uint32_t)EPOLLOUT : 0u);
+	event.data.fd = socket;
+	return epoll_ctl(_epoll, EPOLL_CTL_MOD, socket, &event) == 0;
+}
+
+int Poller::wait(std::vector<PollEvent>& events, int timeout) {
+	events.clear();
+
+	const int count = epoll_wait(_epoll, _events.data(), _events.size(), timeout);
+	for (int i = 0; i < count; ++i) {
+		const auto flags = _events[i].events;
+		events.push_back({
+			_events[i].data.fd,
+			(flags & EPOLLIN) != 0,
+			(flags & EPOLLOUT) != 0,
+			(flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0
+		});
+	}
+
+	return events.size();
+}
+
+#else
+
+#ifdef _WIN32
+#define poll_sockets WSAPoll
+#else
+#define poll_sockets poll
+#endif
+
+Poller::Poller()
+{}
+
+Poller::~Poller()
+{}
+
+bool Poller::add(socket_t socket) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	pollfd fd = {};
+	fd.fd = socket;
+	fd.events = POLLIN;
+	_fds.push_back(fd);
+	return true;
+}
+
+void Poller::remove(socket_t socket) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_fds.erase(std::remove_if(_fds.begin(), _fds.end(), [socket](const pollfd& fd) { return fd.fd == socket; }), _fds.end());
+}
+
+bool Poller::set_write(socket_t socket, bool write) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& fd : _fds) {
+		if (fd.fd == socket) {
+			fd.events = POLLIN | (write ? POLLOUT : 0);
+			return true;
+		}
+	}
+	return false;
+}
+
+// polls a copy so the set can change while waiting -- changes apply on the next wait
+int Poller::wait(std::vector<PollEvent>& events, int timeout) {
+	events.clear();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_poll_fds = _fds;
+	}
+
+	if (_poll_fds.empty()) {
+		return 0;
+	}
+
+	const int count = poll_sockets(_poll_fds.data(), _poll_fds.size(), timeout);
+	if (count <= 0) {
+		return 0;
+	}
+
+	for (const auto& fd : _poll_fds) {
+		if (fd.revents == 0) {
+			continue;
+		}
+
+		events.push_back({
+			fd.fd,
+			(fd.revents & POLLIN) != 0,
+			(fd.revents & POLLOUT) != 0,
+			(fd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0
+		});
+	}
+
+	return events.size();
+}
+
+#endif
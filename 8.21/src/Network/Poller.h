@@ -0,0 +1,49 @@
+#ifndef POLLER_H
+#define POLLER_H
+
+#include <vector>
+#include <mutex>
+
+#include "Socket.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
+struct PollEvent {
+	socket_t socket;
+	bool read;
+	bool write;
+	bool error;
+};
+
+// Readiness notification for many sockets on one thread
+// epoll on linux -- WSAPoll / poll everywhere else
+// add / remove / set_write are safe to call while another thread waits
+class Poller {
+public:
+	Poller();
+	~Poller();
+
+	bool add(socket_t socket);
+	void remove(socket_t socket);
+
+	// also report when the socket can be written to
+	bool set_write(socket_t socket, bool write);
+
+	// blocks up to timeout ms -- returns the number of events
+	int wait(std::vector<PollEvent>& events, int timeout);
+private:
+#ifdef __linux__
+	int _epoll;
+	std::vector<epoll_event> _events;
+#else
+	std::vector<pollfd> _fds;
+	std::vector<pollfd> _poll_fds;
+	std::mutex _mutex;
+#endif
+};
+
+#endif
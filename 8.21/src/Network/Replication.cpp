@@ -0,0 +1,150 @@
+#include "Replication.h"
+
+#include "../src/Entities/Components/TransformComponent.h"
+#include "../src/System/Environment.h"
+#include "../src/System/ResourceManager.h"
+#include "../src/Resources/Terrain.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define HEIGHT_SCALE 256.0f
+#define YAW_SCALE (65536.0f / 360.0f)
+
+uint16_t quantize(float value, float range) {
+	const float q = std::clamp(value / range, 0.0f, 1.0f) * 65535.0f;
+	return (uint16_t)(q + 0.5f);
+}
+
+float dequantize(uint16_t value, float range) {
+	return (value / 65535.0f) * range;
+}
+
+uint16_t quantize_yaw(float degrees) {
+	float yaw = fmod(degrees, 360.0f);
+	if (yaw < 0.0f) {
+		yaw += 360.0f;
+	}
+	return (uint16_t)(yaw * YAW_SCALE);
+}
+
+float dequantize_yaw(uint16_t yaw) {
+	return yaw / YAW_SCALE;
+}
+
+float replication_range() {
+	const auto terrain = Environment::get().get_resource_manager()->get_terrain_data();
+	return terrain ? terrain->get_world_size() : 1.0f;
+}
+
+EntityState make_entity_state(TransformComponent& transform, float range) {
+	const glm::vec3 position = transform._transform.get_position();
+
+	EntityState state;
+	state.position[0] = quantize(position.x, range);
+	state.position[1] = quantize(position.z, range);
+	state.height = (int16_t)std::clamp(position.y * HEIGHT_SCALE, -32768.0f, 32767.0f);
+	state.destination[0] = quantize(transform._destination.x, range);
+	state.destination[1] = quantize(transform._destination.z, range);
+	state.yaw = quantize_yaw(transform._transform.get_rotation().y);
+	state.flags = transform._dest_reached ? STATE_DEST_REACHED : 0;
+
+	return state;
+}
+
+glm::vec3 state_position(const EntityState& state, float range) {
+	return glm::vec3(dequantize(state.position[0], range), state.height / HEIGHT_SCALE, dequantize(state.position[1], range));
+}
+
+// only x / z are sent -- y is where the server's unit ends up on the terrain
+glm::vec3 state_destination(const EntityState& state, float range, TerrainData* terrain) {
+	const float x = dequantize(state.destination[0], range);
+	const float z = dequantize(state.destination[1], range);
+
+	return glm::vec3(x, terrain ? terrain->exact_height(x, z) : 0.0f, z);
+}
+
+uint8_t delta_mask(const EntityState& baseline, const EntityState& state) {
+	uint8_t mask = 0;
+	if (baseline.position[0] != state.position[0] || baseline.position[1] != state.position[1] || baseline.height != state.height) {
+		mask |= DELTA_POSITION;
+	}
+	if (baseline.destination[0] != state.destination[0] || baseline.destination[1] != state.destination[1]) {
+		mask |= DELTA_DESTINATION;
+	}
+	if (baseline.yaw != state.yaw) {
+		mask |= DELTA_ROTATION;
+	}
+	if (baseline.flags != state.flags) {
+		mask |= DELTA_FLAGS;
+	}
+	return mask;
+}
+
+void write_delta(PacketData& packet, uint8_t mask, const EntityState& state) {
+	packet.add(mask);
+	if (mask & DELTA_POSITION) {
+		packet.add(state.position[0], state.height, state.position[1]);
+	}
+	if (mask & DELTA_DESTINATION) {
+		packet.add(state.destination[0], state.destination[1]);
+	}
+	if (mask & DELTA_ROTATION) {
+		packet.add(state.yaw);
+	}
+	if (mask & DELTA_FLAGS) {
+		packet.add(state.flags);
+	}
+}
+
+int delta_size(uint8_t mask) {
+	int size = sizeof(uint8_t);
+	if (mask & DELTA_POSITION)		size += sizeof(uint16_t) * 3;
+	if (mask & DELTA_DESTINATION)	size += sizeof(uint16_t) * 2;
+	if (mask & DELTA_ROTATION)		size += sizeof(uint16_t);
+	if (mask & DELTA_FLAGS)			size += sizeof(uint8_t);
+	return size;
+}
+
+int read_delta(const char* buf, int size, EntityState* state) {
+	if (size < (int)sizeof(uint8_t)) {
+		return -1;
+	}
+
+	const uint8_t mask = buf[0];
+	const int bytes = delta_size(mask);
+	if (size < bytes) {
+		return -1;
+	}
+
+	if (!state) {
+		return bytes;
+	}
+
+	const char* ptr = buf + sizeof(uint8_t);
+
+	if (mask & DELTA_POSITION) {
+		memcpy(&state->position[0], ptr, sizeof(uint16_t));
+		memcpy(&state->height, ptr + 2, sizeof(int16_t));
+		memcpy(&state->position[1], ptr + 4, sizeof(uint16_t));
+		ptr += sizeof(uint16_t) * 3;
+	}
+
+	if (mask & DELTA_DESTINATION) {
+		memcpy(&state->destination[0], ptr, sizeof(uint16_t));
+		memcpy(&state->destination[1], ptr + 2, sizeof(uint16_t));
+		ptr += sizeof(uint16_t) * 2;
+	}
+
+	if (mask & DELTA_ROTATION) {
+		memcpy(&state->yaw, ptr, sizeof(uint16_t));
+		ptr += sizeof(uint16_t);
+	}
+
+	if (mask & DELTA_FLAGS) {
+		state->flags = *ptr;
+		ptr += sizeof(uint8_t);
+	}
+
+	return bytes;
+}
@@ -0,0 +1,54 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Packet.h"
+
+class TransformComponent;
+class TerrainData;
+
+// Quantized replicated transform state -- what the server last sent a client is its baseline
+// x / z are scaled across the map, y is 1/256 units
+struct EntityState {
+	uint16_t position[2] = { 0, 0 };
+	int16_t height = 0;
+	uint16_t destination[2] = { 0, 0 };
+	uint16_t yaw = 0;
+	uint8_t flags = 0;
+};
+
+// fields in a delta -- written in this order
+enum {
+	DELTA_POSITION		= 1 << 0,	// uint16 x, int16 y, uint16 z
+	DELTA_DESTINATION	= 1 << 1,	// uint16 x, uint16 z
+	DELTA_ROTATION		= 1 << 2,	// uint16 yaw
+	DELTA_FLAGS			= 1 << 3	// uint8
+};
+
+#define STATE_DEST_REACHED 1
+
+// map size in world units -- both sides quantize across it
+float replication_range();
+
+// degrees <-> 1/65536 of a turn
+uint16_t quantize_yaw(float degrees);
+float dequantize_yaw(uint16_t yaw);
+
+EntityState make_entity_state(TransformComponent& transform, float range);
+
+glm::vec3 state_position(const EntityState& state, float range);
+// y is the height of terrain under it -- 0 without terrain
+glm::vec3 state_destination(const EntityState& state, float range, TerrainData* terrain);
+
+// fields that differ from baseline -- 0 if nothing changed
+uint8_t delta_mask(const EntityState& baseline, const EntityState& state);
+void write_delta(PacketData& packet, uint8_t mask, const EntityState& state);
+
+// applies one delta to the client's copy of the state -- state can be null to skip it
+// returns the bytes read, -1 if buf is too short
+int read_delta(const char* buf, int size, EntityState* state);
+
+#endif
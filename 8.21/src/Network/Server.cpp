@@ -6,57 +6,100 @@
 #include <string>
 #include <iterator>
 #include <filesystem>
+#include <array>
 
 #include "Packet.h"
 
 #include "../src/Utility/Clock.h"
-#include "../src/Resources/Window.h"
+#include "../src/Utility/Tick.h"
+#include "../src/Utility/JobSystem.h"
 #include "../src/System/ResourceManager.h"
 
 #include "Fmtout.h"
 
-#include <GLFW/glfw3.h>
-
 
 #define DEFAULT_PORT "23001"
-#define MAX_CLIENTS 12
+#define MAX_CLIENTS 1024
+
+// a client that lets this much pile up in its _sendbuf isnt reading -- it is dropped
+#define MAX_SEND_BUFFER (4 * 1024 * 1024)
+
+// ms s_listen() waits for socket events before checking _accept again
+#define LISTEN_TIMEOUT 100
 
 /********************************************************************************************************************************************************/
 
 void print_error(int val) {
 	if (val == SOCKET_ERROR) {
-		std::cout << "Error --- " << WSAGetLastError() << '\n';
+		std::cout << "Error --- " << socket_error() << '\n';
 	}
 }
 
 /********************************************************************************************************************************************************/
 
+// Headless -- no glfw window or gl context
+// models only load their collision boxes and the map only loads its height map
 WorldServer::WorldServer() :
 	_map_id			( -1 )
 {
-	if (!glfwInit()) {
-		//...
-		assert(NULL);
-	}
-
 	_environment.set_mode(MODE_SERVER);
 
 	Clock* clock = new Clock;
 	_environment.set_clock(clock);
 
-	Window* window = new Window;
-	window->hide();
-	_environment.set_window(window);
+	JobSystem* job_system = new JobSystem;
+	_environment.set_job_system(job_system);
 
 	ResourceManager* resource_manager = new ResourceManager;
 	_environment.set_resource_manager(resource_manager);
-	resource_manager->load_resources(1, 0, 1, 1, 0);
+	resource_manager->load_resources(0, 0, 1, 1, 1);
 }
 
+// units take up finished paths, move, then get pushed out of whatever they walked into
 void WorldServer::update() {
-	for(auto it : _entities) {
-		it.second->update();
+	const auto pathfinder = _environment.get_resource_manager()->get_pathfinder();
+
+	pathfinder->update(_paths);
+	for (const auto& path : _paths) {
+		const auto entity = _entities.get(path.id);
+		const auto transform = entity ? (*entity)->get<TransformComponent>() : nullptr;
+		if (!transform) {
+			pathfinder->cancel(path.id);
+			continue;
+		}
+
+		const bool applied = path.field ?
+			transform->set_flow_field(path.field, path.waypoints.back(), path.radius, path.repair) :
+			transform->set_path(path.waypoints, path.first, path.repair);
+
+		// a repair for a unit that already arrived -- nothing left to keep up to date
+		if (!applied) {
+			pathfinder->cancel(path.id);
+			continue;
+		}
+
+		_followers[path.id] = path.serial;
+	}
+	_paths.clear();
+
+	TransformComponent::update_all();
+
+	for (auto it = _followers.begin(); it != _followers.end();) {
+		const auto [id, serial] = *it;
+		const auto entity = _entities.get(id);
+		const auto transform = entity ? (*entity)->get<TransformComponent>() : nullptr;
+
+		if (transform && !transform->_dest_reached) {
+			pathfinder->progress(id, serial, transform->_transform.get_position(), transform->_path_index);
+			++it;
+			continue;
+		}
+
+		pathfinder->arrived(id, serial);
+		it = _followers.erase(it);
 	}
+
+	_collisions.resolve(_entities, _spatial_grid, _environment.get_resource_manager()->get_terrain_data().get());
 }
 
 void WorldServer::load() {
@@ -64,36 +107,73 @@ void WorldServer::load() {
 
 	// load map entities to server
 
-	for (auto& p : std::filesystem::directory_iterator("Data\\Map\\Entities")) {
+	_spatial_grid.resize(_environment.get_resource_manager()->get_terrain_data().get());
+
+	for (auto& p : std::filesystem::directory_iterator("Data/Map/Entities")) {
 		auto entity = std::make_shared<Entity>();
 		entity->load(p.path().string());
-		_entities.insert({ entity->get_unique_id(), entity });
+		entity->set_unique_id(_entities.insert(entity));
+		index_entity(entity);
+	}
+}
+
+void WorldServer::index_entity(const std::shared_ptr<Entity>& entity) {
+	if (const auto transform = entity->get<TransformComponent>()) {
+		_spatial_grid.update(entity->get_unique_id(), transform->get_collision_box());
+
+		if (transform->_collidable && entity->get_type() == ENTITY_OBJECT) {
+			_environment.get_resource_manager()->get_pathfinder()->occupy(transform->get_collision_box());
+		}
 	}
 }
 
 /********************************************************************************************************************************************************/
 
+// Opcode -> handler -- built at compile time, SERVER_HELLO is handled on the network thread
+constexpr std::array<ServerCommand, TOTAL_SERVER_COMMANDS> make_server_commands() {
+	std::array<ServerCommand, TOTAL_SERVER_COMMANDS> commands{};
+	commands[SERVER_LOAD_WORLD] = &Server::load_world_server_to_client;
+	commands[SERVER_NEW_ENTITY] = &Server::new_entity;
+	commands[SERVER_SET_DESTINATION] = &Server::set_destination;
+	commands[SERVER_SET_VIEW] = &Server::set_view;
+	commands[SERVER_GROUP_MOVE] = &Server::group_move;
+	return commands;
+}
+
+constexpr auto SERVER_COMMANDS = make_server_commands();
+
 Server::Server() :
-	_listen_socket		( INVALID_SOCKET ),
+	_accept				( false ),
 	_started			( false ),
-	_accept				( false )
-{}
+	_running			( false ),
+	_next_client_id		( 0 ),
+	_tick_rate			( tick_load_rate() ),
+	_tick				( 0 ),
+	_listen_socket		( INVALID_SOCKET )
+{
+	// WorldServer::update() runs once per tick
+	_environment.get_clock()->set_step(1.0 / _tick_rate);
+}
 
 Server::~Server() {
-	closesocket(_listen_socket);
+	for (auto& client : _clients) {
+		_poller.remove(client->_client_socket);
+	}
+	_clients.clear();
+	_sockets.clear();
+
+	socket_close(_listen_socket);
 
 	if (_started) {
-		WSACleanup();
+		socket_cleanup();
 	}
 }
 
 void Server::s_startup() {
-	int r_startup = WSAStartup(MAKEWORD(2, 2), &_wsa_data);
-	std::cout << "WSAStartup --- " << r_startup << '\n';
-	_started = true;
+	_started = socket_startup();
 
 	addrinfo* result, * ptr, hints;
-	ZeroMemory(&hints, sizeof(hints));
+	memset(&hints, 0, sizeof(hints));
 	hints.ai_family = AF_INET;
 	hints.ai_socktype = SOCK_STREAM;
 	hints.ai_protocol = IPPROTO_TCP;
@@ -105,7 +185,7 @@ void Server::s_startup() {
 	for (ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
 		_listen_socket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
 		if (_listen_socket == INVALID_SOCKET) {
-			std::cout << "socket Error --- " << WSAGetLastError() << '\n';
+			std::cout << "socket Error --- " << socket_error() << '\n';
 			continue;
 		}
 
@@ -113,6 +193,8 @@ void Server::s_startup() {
 		std::cout << "bind --- " << r_bind << '\n';
 		if (r_bind == SOCKET_ERROR) {
 			print_error(r_bind);
+			socket_close(_listen_socket);
+			_listen_socket = INVALID_SOCKET;
 			continue;
 		}
 
@@ -127,40 +209,231 @@ void Server::s_startup() {
 	std::cout << "listen --- " << r_listen << '\n';
 	print_error(r_listen);
 
-	load_server_commands();
+	socket_set_nonblocking(_listen_socket);
+	_poller.add(_listen_socket);
+
 	WorldServer::load();
+
+	_interest.resize(Environment::get().get_resource_manager()->get_terrain_data().get());
 }
 
-void Server::s_accept() {
+// Fixed rate simulation loop -- i_server_tick_rate in Data/system.txt
+void Server::run() {
+	Tick tick(_tick_rate);
+	fmtout("Tick Rate --- ", tick.get_rate());
+
+	_running = true;
+	while (_running) {
+		tick.start();
+
+		process_commands();
+		WorldServer::update();
+		++_tick;
+		replicate();
+
+		tick.finish();
+
+		if (tick.update()) {
+			fmtout("Ticks --- ", tick.get_ticks(), "Avg ms --- ", tick.get_average_ms(), "Max ms --- ", tick.get_max_ms(), "Overruns --- ", tick.get_overruns());
+			tick.reset_stats();
+		}
+	}
+}
+
+void Server::stop() {
+	_running = false;
+}
+
+// Tick thread -- moves entities between interest cells then sends each client
+// the entities that entered / left its area of interest and one delta packet for the rest
+void Server::replicate() {
+	const float range = replication_range();
+
+	_states.clear();
+	for (const auto& e : _entities) {
+		if (const auto transform = e->get<TransformComponent>()) {
+			_states.insert_at(e->get_unique_id(), make_entity_state(*transform, range));
+			_interest.update(e->get_unique_id(), transform->_transform.get_position());
+		}
+	}
+
+	_m.lock();
+	const auto clients = _clients;
+	_m.unlock();
+
+	for (const auto& client : clients) {
+		if (!client->_in_world) {
+			continue;
+		}
+
+		replicate_interest(client);
+		replicate_deltas(client);
+	}
+}
+
+// Tick thread -- entities without a transform have no cell and are never sent
+void Server::replicate_interest(std::shared_ptr<ServerClient> client) {
+	PacketData removed(CLIENT_REMOVE_ENTITIES, 0);
+	int removed_count = 0;
+
+	// erasing reorders ids() -- collect first
+	_removed.clear();
+	for (const auto id : client->_baselines.ids()) {
+		if (!_interest.in_range(id, client->_view_cell, INTEREST_RADIUS + 1) || !_entities.contains(id)) {
+			_removed.push_back(id);
+		}
+	}
+
+	for (const auto id : _removed) {
+		client->_baselines.erase(id);
+		removed.add(id);
+		++removed_count;
+	}
+
+	if (removed_count > 0) {
+		removed.set(PACKET_HEADER_SIZE, removed_count);
+		int len = removed.length();
+		s_send(removed.c_str(), &len, client->_id);
+	}
+
+	_visible.clear();
+	_interest.query(client->_view_cell, INTEREST_RADIUS, _visible);
+
+	PacketData entered(CLIENT_LOAD_WORLD, 0);
+	int entered_count = 0;
+
+	for (const auto id : _visible) {
+		if (client->_baselines.contains(id)) {
+			continue;
+		}
+
+		const auto entity = _entities.get(id);
+		if (!entity) {
+			continue;
+		}
+
+		const int size_offset = entered.length();
+		entered.add(0);
+		(*entity)->packet_data(entered);
+		entered.set(size_offset, entered.length() - size_offset - sizeof(int));
+
+		set_baseline(client, *entity);
+		++entered_count;
+	}
+
+	if (entered_count > 0) {
+		entered.set(PACKET_HEADER_SIZE, entered_count);
+		int len = entered.length();
+		s_send(entered.c_str(), &len, client->_id);
+	}
+}
+
+// Tick thread -- one packet with the fields that changed since the client's baselines
+// sent every tick even if empty -- it tells the client which entities stood still
+void Server::replicate_deltas(std::shared_ptr<ServerClient> client) {
+	PacketData packet(CLIENT_ENTITY_DELTA, _tick, 0);
+	int count = 0;
+
+	auto& baselines = client->_baselines.values();
+	const auto& ids = client->_baselines.ids();
+
+	for (size_t i = 0; i < baselines.size(); ++i) {
+		const auto state = _states.get(ids[i]);
+		if (!state) {
+			continue;
+		}
+
+		const uint8_t mask = delta_mask(baselines[i], *state);
+		if (!mask) {
+			continue;
+		}
+
+		packet.add(ids[i]);
+		write_delta(packet, mask, *state);
+		baselines[i] = *state;
+		++count;
+	}
+
+	packet.set(PACKET_HEADER_SIZE + sizeof(unsigned int), count);
+	int len = packet.length();
+	s_send(packet.c_str(), &len, client->_id);
+}
+
+// Tick thread -- call whenever the client is sent the full entity
+void Server::set_baseline(std::shared_ptr<ServerClient> client, std::shared_ptr<Entity> entity) {
+	if (const auto transform = entity->get<TransformComponent>()) {
+		const EntityState state = make_entity_state(*transform, replication_range());
+		if (const auto baseline = client->_baselines.get(entity->get_unique_id())) {
+			*baseline = state;
+		}
+		else {
+			client->_baselines.insert_at(entity->get_unique_id(), state);
+		}
+	}
+}
+
+// Network thread -- one event loop for the listen socket and every client
+void Server::s_listen() {
+	std::vector<PollEvent> events;
+
 	_accept = true;
 	while (_accept) {
-		SOCKET client_socket = INVALID_SOCKET;
+		_poller.wait(events, LISTEN_TIMEOUT);
+
+		for (const auto& e : events) {
+			if (e.socket == _listen_socket) {
+				s_accept();
+				continue;
+			}
+
+			auto it = _sockets.find(e.socket);
+			if (it == _sockets.end()) {
+				continue;
+			}
+			const auto client = it->second;
+
+			if ((e.read || e.error) && !s_recieve(client)) {
+				s_close(client);
+				continue;
+			}
+
+			if (e.write && !s_flush(client)) {
+				s_close(client);
+			}
+		}
+	}
+}
 
-		fmtout("Waiting for client...");
-		client_socket = accept(_listen_socket, nullptr, nullptr);
+// Accepts every pending connection
+void Server::s_accept() {
+	while (true) {
+		socket_t client_socket = accept(_listen_socket, nullptr, nullptr);
 		if (client_socket == INVALID_SOCKET) {
-			fmtout("Client Accept Error --- ", WSAGetLastError);
+			const int error = socket_error();
+			if (!socket_would_block(error)) {
+				fmtout("Client Accept Error --- ", error);
+			}
+			return;
 		}
-		assert((client_socket != INVALID_SOCKET));
 		fmtout("New Connection");
 
-		if (_clients.size() >= MAX_CLIENTS) {
-			// reject
+		if (_sockets.size() >= MAX_CLIENTS) {
+			fmtout("Client Rejected --- Server Full");
+			socket_close(client_socket);
 			continue;
 		}
 
-		auto client = std::make_shared<ServerClient>(client_socket, _clients.size());
+		socket_set_nonblocking(client_socket);
+		socket_set_nodelay(client_socket);
+
+		auto client = std::make_shared<ServerClient>(client_socket, _next_client_id++);
 
 		_m.lock();
 		_clients.push_back(client);
 		_m.unlock();
 
-		client->_thread = std::thread(&Server::s_recieve, this, client);
-
-		PacketData data("set_id", client->_id);
-		int len = data.length();
-
-		s_send(data.c_str(), &len, client->_id);
+		_sockets.insert({ client_socket, client });
+		_poller.add(client_socket);
 	}
 }
 
@@ -168,60 +441,93 @@ void Server::s_decline() {
 	_accept = false;
 }
 
-void Server::s_recieve(std::shared_ptr<ServerClient> client) {
-	char recvbuf[2048];
-	char* ptr;
-	int r_recv = -1;
-	int recvbuflen = 1024;
-	int bytes_handled = 0;
-	int remaining_bytes = 0;
-	int packet_length = 0;
-
-	do {
-		bytes_handled = 0;
-		r_recv = recv(client->_client_socket, recvbuf + remaining_bytes, recvbuflen, 0);
-		if (r_recv > 0) {
-			dbgout("Receiving...", r_recv);
-			ptr = recvbuf;
-			remaining_bytes = r_recv + remaining_bytes;
-
-			if (remaining_bytes >= 4) {
-				memcpy(&packet_length, ptr, sizeof(int));
-
-				while (remaining_bytes >= packet_length) {
-					dbgout("Command --- ", ptr + 4); // command
-
-					const char* key = ptr + 4; // skip int header
-					int command_length = strlen(ptr + 4) + 1;
-					if (_server_commands.find(key) == _server_commands.end()) {
-						dbgout("Unknown Server Command --- ", key);
-					}
-					else {
-						(this->*_server_commands.at(ptr + 4))(static_cast<void*>(ptr + command_length + 4), packet_length - command_length - 4);
-					}
-
-					bytes_handled += packet_length;
-					remaining_bytes -= packet_length;
-
-					if (remaining_bytes >= 4) {
-						ptr = recvbuf + bytes_handled;
-						memcpy(&packet_length, ptr, sizeof(int));
-					}
-				}
+// Reads until the socket would block and queues every complete packet
+// returns false once the connection is closed
+bool Server::s_recieve(std::shared_ptr<ServerClient> client) {
+	PacketBuffer& recvbuf = client->_recvbuf;
 
+	while (true) {
+		int r_recv = recv(client->_client_socket, recvbuf.write_ptr(), recvbuf.write_space(), 0);
+		if (r_recv == 0) {
+			fmtout("Close Connection");
+			return false;
+		}
+		if (r_recv < 0) {
+			const int error = socket_error();
+			if (socket_would_block(error)) {
+				return true;
 			}
+			fmtout("Recv Error --- ", error);
+			return false;
+		}
 
-			if (remaining_bytes > 0) {
-				memcpy(recvbuf, ptr, remaining_bytes);
+		dbgout("Receiving...", r_recv);
+		recvbuf.commit(r_recv);
+
+		char* ptr = nullptr;
+		int packet_length = 0;
+		while ((packet_length = recvbuf.next_packet(&ptr)) > 0) {
+			const Opcode opcode = ptr[sizeof(int)];
+			const char* data = ptr + PACKET_HEADER_SIZE;
+			const int data_size = packet_length - PACKET_HEADER_SIZE;
+			dbgout("Command --- ", (int)opcode);
+
+			if (!client->_hello) {
+				if (opcode != SERVER_HELLO || !hello(client, data, data_size)) {
+					return false;
+				}
 			}
+			else if (opcode >= TOTAL_SERVER_COMMANDS || !SERVER_COMMANDS[opcode]) {
+				dbgout("Unknown Server Command --- ", (int)opcode);
+			}
+			else {
+				queue_command(SERVER_COMMANDS[opcode], data, data_size);
+			}
+
+			recvbuf.consume(packet_length);
 		}
-		else if (r_recv == 0) {
-			fmtout("Close Connection");
+
+		if (packet_length == PACKET_INVALID) {
+			fmtout("Invalid Packet --- Closing Connection");
+			return false;
 		}
-		else {
-			fmtout("Recv Error --- ", WSAGetLastError());
+	}
+}
+
+// Sends whatever s_send() couldn't -- returns false on a socket error
+bool Server::s_flush(std::shared_ptr<ServerClient> client) {
+	std::lock_guard<std::mutex> lock(client->_send_mutex);
+
+	if (client->_dropped) {
+		return false;
+	}
+
+	int total = 0;
+	const int len = client->_sendbuf.size();
+	while (total < len) {
+		int r_send = send(client->_client_socket, client->_sendbuf.data() + total, len - total, SOCKET_SEND_FLAGS);
+		if (r_send == SOCKET_ERROR) {
+			const int error = socket_error();
+			if (socket_would_block(error)) {
+				break;
+			}
+			dbgout("Send Error --- ", error);
+			return false;
 		}
-	} while (r_recv > 0);
+		total += r_send;
+	}
+
+	client->_sendbuf.erase(client->_sendbuf.begin(), client->_sendbuf.begin() + total);
+	if (client->_sendbuf.empty()) {
+		_poller.set_write(client->_client_socket, false);
+	}
+
+	return true;
+}
+
+void Server::s_close(std::shared_ptr<ServerClient> client) {
+	_poller.remove(client->_client_socket);
+	_sockets.erase(client->_client_socket);
 
 	_m.lock();
 	auto it = _clients.begin();
@@ -234,28 +540,32 @@ void Server::s_recieve(std::shared_ptr<ServerClient> client) {
 	_m.unlock();
 }
 
+// Never blocks -- anything the socket won't take is kept and sent by s_listen() when writable
 bool Server::s_send(const char* data, int* len, int client_id) {
-	assert(*len <= 1024);
-
-	std::shared_ptr<ServerClient> client = nullptr;
-	for(const auto c : _clients) {
-		if(c->_id == client_id) {
-			client = c;
-		}
-	}
+	std::shared_ptr<ServerClient> client = find_client(client_id);
 	if(!client) {
 		// client doesnt exist / disconnected
 		std::cout << "Client -- " << client_id << " Doesnt exist " << '\n';
 		return false;
 	}
 
+	std::lock_guard<std::mutex> lock(client->_send_mutex);
+
+	if (client->_dropped) {
+		return false;
+	}
+
 	int total = 0;
 	int bytes_left = *len;
-	while (total < bytes_left) {
-		int r_send = send(client->_client_socket, data + total, bytes_left, 0);
+	while (client->_sendbuf.empty() && bytes_left > 0) {
+		int r_send = send(client->_client_socket, data + total, bytes_left, SOCKET_SEND_FLAGS);
 		dbgout("Sending...", r_send);
 		if (r_send == SOCKET_ERROR) {
-			dbgout("Send Error --- ", WSAGetLastError());
+			const int error = socket_error();
+			if (socket_would_block(error)) {
+				break;
+			}
+			dbgout("Send Error --- ", error);
 			return false;
 		}
 
@@ -263,73 +573,130 @@ bool Server::s_send(const char* data, int* len, int client_id) {
 		bytes_left -= r_send;
 	}
 
-	*len = total;
+	// the network thread sees the shutdown and s_close()s it -- the socket stays open until then
+	if (client->_sendbuf.size() + bytes_left > MAX_SEND_BUFFER) {
+		fmtout("Send Buffer Full --- Dropping Client", client->_id);
+		client->_dropped = true;
+		std::vector<char>().swap(client->_sendbuf);
+		socket_shutdown(client->_client_socket);
+		return false;
+	}
+
+	if (bytes_left > 0) {
+		const bool was_empty = client->_sendbuf.empty();
+		client->_sendbuf.insert(client->_sendbuf.end(), data + total, data + total + bytes_left);
+		if (was_empty) {
+			_poller.set_write(client->_client_socket, true);
+		}
+	}
 
 	return true;
 }
 
-void Server::load_server_commands() {
-	_server_commands.emplace("load_world_server", &Server::load_world_server_to_client);
-	_server_commands.emplace("new_entity", &Server::new_entity);
-	_server_commands.emplace("set_destination", &Server::set_destination);
+void Server::s_broadcast(const char* data, int len) {
+	_m.lock();
+	const auto clients = _clients;
+	_m.unlock();
+
+	for (const auto& client : clients) {
+		int client_len = len;
+		s_send(data, &client_len, client->_id);
+	}
+}
+
+std::shared_ptr<ServerClient> Server::find_client(int client_id) {
+	std::lock_guard<std::mutex> lock(_m);
+	for (const auto& c : _clients) {
+		if (c->_id == client_id) {
+			return c;
+		}
+	}
+	return nullptr;
+}
+
+// Network thread -- version check before anything else is accepted
+// Params: int version
+bool Server::hello(std::shared_ptr<ServerClient> client, const char* buf, int size) {
+	int version = -1;
+	if (size == sizeof(int)) {
+		memcpy(&version, buf, sizeof(int));
+	}
+
+	if (version != PROTOCOL_VERSION) {
+		fmtout("Protocol Version Mismatch --- ", version, "Expected --- ", PROTOCOL_VERSION);
+		return false;
+	}
+
+	client->_hello = true;
+
+	PacketData data(CLIENT_SET_ID, client->_id, PROTOCOL_VERSION, _tick_rate);
+	int len = data.length();
+
+	return s_send(data.c_str(), &len, client->_id);
+}
+
+// Network thread -- the packet is copied out of the recieve buffer
+void Server::queue_command(ServerCommand command, const char* buf, int size) {
+	_commands.push({ command, std::vector<uint8_t>(buf, buf + size) });
+}
+
+// Tick thread -- runs every command recieved since the last tick in one batch
+// handlers are the only place _entities is changed so they never race with update()
+void Server::process_commands() {
+	_commands.drain([this](QueuedCommand& c) {
+		(this->*c.command)(static_cast<void*>(c.data.data()), c.data.size());
+	});
 }
 
 // Params: int client_id
+// The client is sent the entities around its view by the replicate() at the end of this tick
+// in one CLIENT_LOAD_WORLD packet -- the rest follow as its view moves
 void Server::load_world_server_to_client(void* buf, int size) {
 	assert(size == sizeof(int));
 	int client_id;
 	memcpy(&client_id, buf, sizeof(int));
 
-	assert(_clients.size() >= client_id);
-
-	for(const auto e : _entities) {
-		auto packet_data_vec = e.second->packet_data();
-		PacketData packet("load_entity");
-
-		for(auto& p : packet_data_vec) {
-			packet.add(std::move(p));
-		}
-		int len = packet.length();
-
-		s_send(packet.c_str(), &len, client_id);
+	if (const auto client = find_client(client_id)) {
+		client->_in_world = true;
 	}
 }
 
-// Params: int client_id, Entity entity
+// Params: int client_id, EntityId local_id, Entity entity
+// the server picks the id -- the client is told which of its local ids it became
 void Server::new_entity(void* buf, int size) {
-	assert(size >= sizeof(int));
+	assert(size >= (int)(sizeof(int) + sizeof(EntityId)));
+	char* ptr = static_cast<char*>(buf);
+
 	int client_id;
-	memcpy(&client_id, buf, sizeof(int));
+	memcpy(&client_id, ptr, sizeof(int));
 
-	assert(_clients.size() >= client_id);
+	EntityId local_id;
+	memcpy(&local_id, ptr + sizeof(int), sizeof(EntityId));
 
-	char* ptr = static_cast<char*>(buf);
-	ptr = ptr + 4;
-	size -= 4;
+	ptr += sizeof(int) + sizeof(EntityId);
+	size -= sizeof(int) + sizeof(EntityId);
 
 	std::shared_ptr<Entity> entity = std::make_shared<Entity>();
-
-	int unique_id = entity->get_unique_id();
 	entity->load_buffer(static_cast<void*>(ptr), size);
-	entity->set_unique_id(unique_id);
 
-	_entities.insert({ entity->get_unique_id(), entity });
-
-	std::cout << "UNIQUE ID: " << entity->get_unique_id() << '\n';
-	
-	PacketData packet("load_entity");
-	auto packet_vector = entity->packet_data();
-	for(auto& p : packet_vector) {
-		packet.add(std::move(p));
+	const EntityId id = _entities.insert(entity);
+	if (id == INVALID_ENTITY_ID) {
+		fmtout("Entity Limit Reached");
+		return;
 	}
+	entity->set_unique_id(id);
+	index_entity(entity);
 
-	for(const auto client : _clients) {
-		int len = packet.length();
-		s_send(packet.c_str(), &len, client->_id);
-	}
+	dbgout("New Entity --- ", id);
+
+	PacketData packet(CLIENT_ENTITY_CREATED, local_id, id);
+	int len = packet.length();
+	s_send(packet.c_str(), &len, client_id);
+
+	// sent to the clients that can see it by replicate() at the end of the tick
 }
 
-// int client id, int entity_id, vec3 destination
+// int client id, EntityId entity_id, vec3 destination
 void Server::set_destination(void* buf, int size) {
 	// verify bytes
 	char* ptr = static_cast<char*>(buf);
@@ -337,38 +704,93 @@ void Server::set_destination(void* buf, int size) {
 	int client_id;
 	memcpy(&client_id, ptr, sizeof(int));
 
-	assert(_clients.size() >= client_id);
-
-	int entity_id;
-	memcpy(&entity_id, ptr + 4, sizeof(int));
+	EntityId entity_id;
+	memcpy(&entity_id, ptr + 4, sizeof(EntityId));
 
 	glm::vec3 destination;
 	memcpy(&destination, ptr + 8, sizeof(glm::vec3));
 
-	if(!_entities.count(entity_id)) {
+	const auto entity = _entities.get(entity_id);
+	if(!entity) {
+		return;
+	}
+
+	// searched on a worker -- the unit sets off once update() picks the path up
+	if (const auto transform = (*entity)->get<TransformComponent>()) {
+		_environment.get_resource_manager()->get_pathfinder()->request(entity_id, transform->_transform.get_position(), destination);
+	}
+}
+
+// Params: int client_id, vec3 destination, int count, EntityId * count
+// the whole group follows one flow field
+void Server::group_move(void* buf, int size) {
+	const size_t header = sizeof(int) * 2 + sizeof(glm::vec3);
+	if (size < 0 || (size_t)size < header) {
+		return;
+	}
+	char* ptr = static_cast<char*>(buf);
+
+	glm::vec3 destination;
+	memcpy(&destination, ptr + sizeof(int), sizeof(glm::vec3));
+	ptr += sizeof(int) + sizeof(glm::vec3);
+
+	int count;
+	memcpy(&count, ptr, sizeof(int));
+	ptr += sizeof(int);
+
+	// compared in size_t -- a huge count cant wrap around to a size that fits
+	const size_t remaining = (size_t)size - header;
+	if (count <= 0 || remaining % sizeof(EntityId) != 0 || (size_t)count != remaining / sizeof(EntityId)) {
 		return;
 	}
 
-	_entities.at(entity_id)->get<TransformComponent>()->set_destination(destination);
+	_group_ids.clear();
+	_group_from.clear();
+	for (int i = 0; i < count; ++i) {
+		EntityId entity_id;
+		memcpy(&entity_id, ptr + i * sizeof(EntityId), sizeof(EntityId));
+
+		const auto entity = _entities.get(entity_id);
+		const auto transform = entity ? (*entity)->get<TransformComponent>() : nullptr;
+		if (transform) {
+			_group_ids.push_back(entity_id);
+			_group_from.push_back(transform->_transform.get_position());
+		}
+	}
+
+	_environment.get_resource_manager()->get_pathfinder()->request_group(_group_ids, _group_from, destination);
+}
+
+// Params: int client_id, vec3 focus
+// focus is where the client's camera looks at the terrain
+void Server::set_view(void* buf, int size) {
+	assert(size == sizeof(int) + sizeof(glm::vec3));
+	char* ptr = static_cast<char*>(buf);
+
+	int client_id;
+	memcpy(&client_id, ptr, sizeof(int));
 
-	PacketData data("set_destination", entity_id, destination);
+	glm::vec3 focus;
+	memcpy(&focus, ptr + sizeof(int), sizeof(glm::vec3));
 
-	for(auto& client : _clients) {
-		int len = data.length();
-		s_send(data.c_str(), &len, client->_id);
+	if (const auto client = find_client(client_id)) {
+		client->_view_cell = _interest.get_cell(focus);
 	}
 }
 
 /********************************************************************************************************************************************************/
 
-ServerClient::ServerClient(SOCKET client_socket, int id) :
-	_id				( id ),
-	_client_socket	( client_socket )
+ServerClient::ServerClient(socket_t client_socket, int id) :
+	_id					( id ),
+	_client_socket		( client_socket ),
+	_hello				( false ),
+	_in_world			( false ),
+	_view_cell			( 0, 0 ),
+	_dropped			( false )
 {}
 
 ServerClient::~ServerClient() {
-	closesocket(_client_socket);
-	_thread.detach();
+	socket_close(_client_socket);
 }
 
 /********************************************************************************************************************************************************/
\ No newline at end of file
@@ -1,18 +1,25 @@
 #ifndef SERVER_H
 #define SERVER_H
 
-#include <winsock2.h>
-#include <WS2tcpip.h>
-
-#pragma comment(lib, "Ws2_32.lib")
-
 #include <vector>
-#include <thread>
 #include <mutex>
+#include <atomic>
 #include <unordered_map>
 
+#include "Socket.h"
+#include "Poller.h"
+#include "PacketBuffer.h"
+#include "Replication.h"
+#include "Interest.h"
+
+#include "../src/Utility/MPSCQueue.h"
+#include "../src/Utility/SlotMap.h"
+#include "../src/Utility/SpatialGrid.h"
+#include "../src/Utility/Pathfinder.h"
+
 #include "../src/System/Environment.h"
 #include "../src/Entities/Entity.h"
+#include "../src/Entities/CollisionResolver.h"
 
 
 /********************************************************************************************************************************************************/
@@ -26,10 +33,23 @@ public:
 	void load();
 
 protected:
+	// puts a new entity in the spatial grid -- placed objects also block their tiles for pathfinding
+	void index_entity(const std::shared_ptr<Entity>& entity);
+
 	int _map_id;
 
-	//std::vector<std::shared_ptr<Entity>> _entities;
-	std::unordered_map<int, std::shared_ptr<Entity>> _entities;
+	// authoritative id space -- an entity's unique id is its slot here
+	SlotMap<std::shared_ptr<Entity>> _entities;
+
+	SpatialGrid _spatial_grid;
+	CollisionResolver _collisions;
+
+	// paths finished since the last update()
+	std::vector<PathResult> _paths;
+
+	// units walking a path or field from the pathfinder -- it hears where they are until they arrive
+	// entity id -> serial of the result it follows
+	std::unordered_map<SlotId, unsigned int> _followers;
 
 	Environment _environment;
 };
@@ -41,31 +61,76 @@ class Server;
 
 typedef void(Server::* ServerCommand)(void* buf, int size);
 
+// command recieved on the network thread -- run on the next tick
+struct QueuedCommand {
+	ServerCommand command;
+	std::vector<uint8_t> data;
+};
+
 class Server : public WorldServer{
 public:
 	Server();
 	~Server();
 
 	void s_startup();
+	void run();
+	void stop();
+	void replicate();
+	void s_listen();
 	void s_accept();
 	void s_decline();
-	void s_recieve(std::shared_ptr<ServerClient> client);
+	bool s_recieve(std::shared_ptr<ServerClient> client);
+	bool s_flush(std::shared_ptr<ServerClient> client);
+	void s_close(std::shared_ptr<ServerClient> client);
 	bool s_send(const char* data, int* len, int client_id);
+	void s_broadcast(const char* data, int len);
+
+	bool hello(std::shared_ptr<ServerClient> client, const char* buf, int size);
+	void queue_command(ServerCommand command, const char* buf, int size);
+	void process_commands();
 
-	void load_server_commands();
 	void load_world_server_to_client(void* buf, int size);
 	void new_entity(void* buf, int size);
 	void set_destination(void* buf, int size);
+	void set_view(void* buf, int size);
+	void group_move(void* buf, int size);
+private:
+	std::shared_ptr<ServerClient> find_client(int client_id);
+	void set_baseline(std::shared_ptr<ServerClient> client, std::shared_ptr<Entity> entity);
+	void replicate_interest(std::shared_ptr<ServerClient> client);
+	void replicate_deltas(std::shared_ptr<ServerClient> client);
 private:
-	bool _accept;
+	std::atomic<bool> _accept;
 	bool _started;
+	std::atomic<bool> _running;
+
+	int _next_client_id;
+
+	// ticks per second and ticks run -- clients time their snapshots with these
+	int _tick_rate;
+	unsigned int _tick;
 
 	std::vector<std::shared_ptr<ServerClient>> _clients;
 
-	std::unordered_map<std::string, ServerCommand> _server_commands;
+	// only touched by the s_listen() thread
+	std::unordered_map<socket_t, std::shared_ptr<ServerClient>> _sockets;
+
+	MPSCQueue<QueuedCommand> _commands;
+
+	// this tick's quantized state for every entity -- reused each replicate()
+	SlotMap<EntityState> _states;
+
+	// entity cells -- updated every replicate()
+	InterestGrid _interest;
+	std::vector<unsigned int> _visible;
+	std::vector<EntityId> _removed;
+
+	// group_move() scratch
+	std::vector<EntityId> _group_ids;
+	std::vector<glm::vec3> _group_from;
 
-	WSAData _wsa_data;
-	SOCKET _listen_socket;
+	socket_t _listen_socket;
+	Poller _poller;
 
 	std::mutex _m;
 };
@@ -74,14 +139,34 @@ private:
 
 class ServerClient {
 public:
-	ServerClient(SOCKET client_socket, int id);
+	ServerClient(socket_t client_socket, int id);
 	~ServerClient();
 private:
 	int _id;
 
-	SOCKET _client_socket;
+	socket_t _client_socket;
+
+	PacketBuffer _recvbuf;
+
+	// set once SERVER_HELLO arrives with a matching PROTOCOL_VERSION
+	bool _hello;
+
+	// set by SERVER_LOAD_WORLD -- nothing is replicated before it
+	bool _in_world;
+
+	// interest cell under the client's camera -- SERVER_SET_VIEW
+	glm::ivec2 _view_cell;
+
+	// tick thread only -- last state sent for every entity the client knows about
+	// TCP delivers in order so what was sent is what the client has
+	// also the client's interest set -- entities enter and leave it in replicate()
+	SlotMap<EntityState> _baselines;
 
-	std::thread _thread;
+	// bytes the socket wouldn't take yet -- flushed when writable
+	std::vector<char> _sendbuf;
+	// _sendbuf passed MAX_SEND_BUFFER -- nothing more is sent, the network thread closes it
+	bool _dropped;
+	std::mutex _send_mutex;
 
 	friend class Server;
 };
@@ -0,0 +1,75 @@
+#include "Socket.h"
+
+#include <iostream>
+
+bool socket_startup() {
+#ifdef _WIN32
+	WSAData wsa_data;
+	int r_startup = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+	std::cout << "WSAStartup --- " << r_startup << '\n';
+	return r_startup == 0;
+#else
+	return true;
+#endif
+}
+
+void socket_cleanup() {
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+void socket_close(socket_t socket) {
+	if (socket == INVALID_SOCKET) {
+		return;
+	}
+
+#ifdef _WIN32
+	closesocket(socket);
+#else
+	close(socket);
+#endif
+}
+
+void socket_shutdown(socket_t socket) {
+	if (socket == INVALID_SOCKET) {
+		return;
+	}
+
+#ifdef _WIN32
+	shutdown(socket, SD_BOTH);
+#else
+	shutdown(socket, SHUT_RDWR);
+#endif
+}
+
+int socket_error() {
+#ifdef _WIN32
+	return WSAGetLastError();
+#else
+	return errno;
+#endif
+}
+
+bool socket_set_nonblocking(socket_t socket) {
+#ifdef _WIN32
+	u_long mode = 1;
+	return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+	const int flags = fcntl(socket, F_GETFL, 0);
+	return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool socket_set_nodelay(socket_t socket) {
+	int flag = 1;
+	return setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&flag), sizeof(flag)) == 0;
+}
+
+bool socket_would_block(int error) {
+#ifdef _WIN32
+	return error == WSAEWOULDBLOCK;
+#else
+	return error == EWOULDBLOCK || error == EAGAIN;
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+// Thin wrapper over WinSock / POSIX sockets
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <WS2tcpip.h>
+
+#pragma comment(lib, "Ws2_32.lib")
+
+typedef SOCKET socket_t;
+
+#define SOCKET_SEND_FLAGS 0
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+
+typedef int socket_t;
+
+#define INVALID_SOCKET (-1)
+#define SOCKET_ERROR (-1)
+
+// no SIGPIPE when the peer has already closed
+#define SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#endif
+
+bool socket_startup();
+void socket_cleanup();
+
+void socket_close(socket_t socket);
+// stops both directions but keeps the handle -- whoever polls it sees the connection close
+void socket_shutdown(socket_t socket);
+int socket_error();
+
+bool socket_set_nonblocking(socket_t socket);
+bool socket_set_nodelay(socket_t socket);
+
+// true if the last call on a nonblocking socket had nothing to do
+bool socket_would_block(int error = socket_error());
+
+#endif
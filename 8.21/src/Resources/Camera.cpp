@@ -32,22 +32,18 @@ Camera::Camera(
 	_right						( glm::vec3(0, 0, 0) ),
 	_up							( glm::vec3(0, 0, 0) ),
 	_view						( glm::mat4() ),
-	_projection					( glm::perspective(fov, aspect, z_near, z_far) )
-{}
-
-void Camera::attach_shader(GLuint program) {
-	glUseProgram(program);
-	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &_projection[0][0]);
-
-	_programs.push_back(program);
+	_projection					( glm::perspective(fov, aspect, z_near, z_far) ),
+	_uniform_buffer				( 0 )
+{
+	const CameraUniforms uniforms = { _projection, _view };
+
+	glCreateBuffers(1, &_uniform_buffer);
+	glNamedBufferStorage(_uniform_buffer, sizeof(CameraUniforms), &uniforms, GL_DYNAMIC_STORAGE_BIT);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, _uniform_buffer);
 }
 
-void Camera::detach_shader(GLuint program) {
-	for (auto it = _programs.begin(); it != _programs.end(); ++it) {
-		if (*it == program) {
-			_programs.erase(it);
-		}
-	}
+Camera::~Camera() {
+	glDeleteBuffers(1, &_uniform_buffer);
 }
 
 void Camera::mode(int mode) {
@@ -164,10 +160,9 @@ void Camera::update() {
 		_up
 	);
 
-	for (auto p : _programs) {
-		glUseProgram(p);
-		glUniformMatrix4fv(glGetUniformLocation(p, "view"), 1, GL_FALSE, &_view[0][0]);
-	}
+	// projection never changes after construction
+	glNamedBufferSubData(_uniform_buffer, offsetof(CameraUniforms, view), sizeof(glm::mat4), &_view[0][0]);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, _uniform_buffer);
 }
 
 int Camera::get_mode() {
@@ -5,7 +5,7 @@
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include <vector>
+#include <cstddef>
 
 #define CAMERA_FORWARD 1
 #define CAMERA_BACKWARD 2
@@ -18,6 +18,15 @@
 #define CAMERA_LOCKED 1
 #define CAMERA_TOGGLE 2
 
+// uniform buffer binding of the Camera block every world shader declares
+#define CAMERA_UNIFORM_BINDING 0
+
+// std140 layout of the Camera block -- two mat4s need no padding
+struct CameraUniforms {
+	glm::mat4 projection;
+	glm::mat4 view;
+};
+
 class Camera {
 public:
 	Camera(
@@ -31,6 +40,10 @@ public:
 		float vertical_angle,
 		glm::vec3 position
 	);
+	~Camera();
+
+	Camera(const Camera&) = delete;
+	Camera& operator=(const Camera&) = delete;
 
 	void move(const int direction, float speed = 0.0f);
 	void move_free(const int direction, float speed = 0.0f);
@@ -38,11 +51,9 @@ public:
 	void move_angle(const float xpos, const float ypos);
 
 	void mode(int mode);
+	// writes view to the uniform buffer and binds it for the frame
 	void update();
 
-	void attach_shader(const GLuint program);
-	void detach_shader(const GLuint program);
-
 	int get_mode();
 
 	glm::vec3 get_direction();
@@ -79,7 +90,8 @@ private:
 
 	glm::vec3 _position;
 
-	std::vector<GLuint> _programs;
+	// CameraUniforms -- shared by every program instead of setting each one's uniforms
+	GLuint _uniform_buffer;
 };
 
 #endif
\ No newline at end of file
@@ -23,7 +23,7 @@
 #define GUI_SHADER 2
 #define GUI_TEXT_SHADER 3
 #define GUI_ICON_SHADER 4
-#define VERDANA_FONT_PATH "Data\\Font\\verdana.png"
+#define VERDANA_FONT_PATH "Data/Font/verdana.png"
 
 constexpr GLfloat vertex_data[12] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f };
 
@@ -77,11 +77,11 @@ void GUIDrawElement::draw(GUIDrawDesc draw_desc, GUIMasterDesc master_desc) {
 						 draw_desc._position.y + master_desc._ypos + master_desc._height - (child_element * draw_desc._height) + master_desc._scroll		// add height
 	);	
 
-	glUniform4fv(glGetUniformLocation(_program, "screen_space"), 1, &master_desc._screen_space[0]);
-	glUniform4fv(glGetUniformLocation(_program, "color"), 1, &draw_desc._color[0]);
-	glUniform2fv(glGetUniformLocation(_program, "position"), 1, &position[0]);
-	glUniform1f(glGetUniformLocation(_program, "width"), draw_desc._width);
-	glUniform1f(glGetUniformLocation(_program, "height"), draw_desc._height);
+	glUniform4fv(_uniforms.screen_space, 1, &master_desc._screen_space[0]);
+	glUniform4fv(_uniforms.color, 1, &draw_desc._color[0]);
+	glUniform2fv(_uniforms.position, 1, &position[0]);
+	glUniform1f(_uniforms.width, draw_desc._width);
+	glUniform1f(_uniforms.height, draw_desc._height);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -95,9 +95,16 @@ void GUIDrawElement::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(GUI_SHADER)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(GUI_SHADER);
+	_program = program->_id;
+	_uniforms.screen_space = program->uniform("screen_space");
+	_uniforms.color = program->uniform("color");
+	_uniforms.position = program->uniform("position");
+	_uniforms.width = program->uniform("width");
+	_uniforms.height = program->uniform("height");
+
 	glUseProgram(_program);
-	glUniformMatrix4fv(glGetUniformLocation(_program, "projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
+	glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
 
 	glCreateBuffers(1, &_vertex_buffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
@@ -197,9 +204,16 @@ void GUIScrollElement::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(GUI_SHADER)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(GUI_SHADER);
+	_program = program->_id;
+	_uniforms.viewport = program->uniform("viewport");
+	_uniforms.color = program->uniform("color");
+	_uniforms.position = program->uniform("position");
+	_uniforms.width = program->uniform("width");
+	_uniforms.height = program->uniform("height");
+
 	glUseProgram(_program);
-	glUniformMatrix4fv(glGetUniformLocation(_program, "projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
+	glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
 
 	glCreateBuffers(1, &_vertex_buffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
@@ -218,11 +232,11 @@ void GUIScrollElement::draw(GUIMasterDesc master_desc) {
 	const float ypos = master_desc._position.y + GUIPositionElement::_height - _height - distance;
 	const auto  position = glm::vec2(xpos, ypos);
 
-	glUniform4fv(glGetUniformLocation(_program, "viewport"), 1, &master_desc._screen_space[0]);
-	glUniform4fv(glGetUniformLocation(_program, "color"), 1, &_color[0]);
-	glUniform2fv(glGetUniformLocation(_program, "position"), 1, &position[0]);
-	glUniform1f(glGetUniformLocation(_program, "width"), 1.3f);
-	glUniform1f(glGetUniformLocation(_program, "height"), 1.5f);
+	glUniform4fv(_uniforms.viewport, 1, &master_desc._screen_space[0]);
+	glUniform4fv(_uniforms.color, 1, &_color[0]);
+	glUniform2fv(_uniforms.position, 1, &position[0]);
+	glUniform1f(_uniforms.width, 1.3f);
+	glUniform1f(_uniforms.height, 1.5f);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -258,10 +272,19 @@ void GUIDrawText::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(GUI_TEXT_SHADER)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(GUI_TEXT_SHADER);
+	_program = program->_id;
+	_uniforms.screen_space = program->uniform("screen_space");
+	_uniforms.scale = program->uniform("scale");
+	_uniforms.color = program->uniform("color");
+	_uniforms.position = program->uniform("position");
+	_uniforms.text_width = program->uniform("text_width");
+	_uniforms.text_height = program->uniform("text_height");
+	_uniforms.text_position = program->uniform("text_position");
+
 	glUseProgram(_program);
 
-	glUniformMatrix4fv(glGetUniformLocation(_program, "projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
+	glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
 
 	glCreateBuffers(1, &_vertex_buffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
@@ -312,6 +335,11 @@ void GUIDrawText::draw(GUITextDesc text_desc, GUIMasterDesc master_desc) {
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+	// the same for every character
+	glUniform4fv(_uniforms.screen_space, 1, &master_desc._screen_space[0]);
+	glUniform1f(_uniforms.scale, text_desc._scale);
+	glUniform4fv(_uniforms.color, 1, &text_desc._color[0]);
+
 	const bool child_element = (master_desc._width + master_desc._height) > 0.0f;
 	const float max_height = text_max_height(text_desc._string);
 	if (child_element) {
@@ -325,13 +353,10 @@ void GUIDrawText::draw(GUITextDesc text_desc, GUIMasterDesc master_desc) {
 		const auto origin = font_map.origin(character) * text_desc._scale;
 		const auto char_position = glm::vec2(text_desc._position.x  , text_desc._position.y - origin.y );
 
-		glUniform4fv(glGetUniformLocation(_program, "screen_space"), 1, &master_desc._screen_space[0]);
-		glUniform1f(glGetUniformLocation(_program, "scale"), text_desc._scale);
-		glUniform4fv(glGetUniformLocation(_program, "color"), 1, &text_desc._color[0]);
-		glUniform2fv(glGetUniformLocation(_program, "position"), 1, &char_position[0]);
-		glUniform1f(glGetUniformLocation(_program, "text_width"), char_width);
-		glUniform1f(glGetUniformLocation(_program, "text_height"), char_height);
-		glUniform2fv(glGetUniformLocation(_program, "text_position"), 1, &font_map.position(character)[0]);
+		glUniform2fv(_uniforms.position, 1, &char_position[0]);
+		glUniform1f(_uniforms.text_width, char_width);
+		glUniform1f(_uniforms.text_height, char_height);
+		glUniform2fv(_uniforms.text_position, 1, &font_map.position(character)[0]);
 
 		glDrawArrays(text_desc._mode, 0, 6);
 
@@ -361,10 +386,17 @@ void GUIDrawIcon::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(GUI_ICON_SHADER)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(GUI_ICON_SHADER);
+	_program = program->_id;
+	_uniforms.screen_space = program->uniform("screen_space");
+	_uniforms.highlight = program->uniform("highlight");
+	_uniforms.width = program->uniform("width");
+	_uniforms.height = program->uniform("height");
+	_uniforms.position = program->uniform("position");
+
 	glUseProgram(_program);
 
-	glUniformMatrix4fv(glGetUniformLocation(_program, "projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
+	glUniformMatrix4fv(program->uniform("projection"), 1, GL_FALSE, &GUI_PROJECTION[0][0]);
 
 	glCreateBuffers(1, &_vertex_buffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
@@ -385,11 +417,11 @@ void GUIDrawIcon::draw(GUIIconDesc icon_desc, GUIMasterDesc master_desc) {
 		icon_desc._position.y + master_desc._height + master_desc._ypos + master_desc._scroll
 	);
 
-	glUniform4fv(glGetUniformLocation(_program, "screen_space"), 1, &master_desc._screen_space[0]);
-	glUniform1i(glGetUniformLocation(_program, "highlight"), icon_desc._highlight);
-	glUniform1f(glGetUniformLocation(_program, "width"), icon_desc._width);
-	glUniform1f(glGetUniformLocation(_program, "height"), icon_desc._height);
-	glUniform2fv(glGetUniformLocation(_program, "position"), 1, &position[0]);
+	glUniform4fv(_uniforms.screen_space, 1, &master_desc._screen_space[0]);
+	glUniform1i(_uniforms.highlight, icon_desc._highlight);
+	glUniform1f(_uniforms.width, icon_desc._width);
+	glUniform1f(_uniforms.height, icon_desc._height);
+	glUniform2fv(_uniforms.position, 1, &position[0]);
 
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 }
@@ -538,9 +570,17 @@ void GUISelectionView::draw(GUIMasterDesc master_desc) {
 		const auto terrain = Environment::get().get_resource_manager()->get_terrain();
 		const auto position = terrain->entity_placement();
 
-		const auto& model = Environment::get().get_resource_manager()->get_model(_selection->get_model_id());
+		const auto resource_manager = Environment::get().get_resource_manager();
+		const auto& model = resource_manager->get_model(_selection->get_model_id());
 		Transform transform(position);
-		model->draw(transform);
+		// instanced programs read the model matrix from the instance buffer -- the uniform path would draw a stale one
+		if (model->is_instanced()) {
+			model->add_instance(transform.get_model());
+			resource_manager->draw_models();
+		}
+		else {
+			model->draw(transform);
+		}
 	}
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 
 typedef unsigned int GLuint;
+typedef int GLint;
 
 struct Texture;
 
@@ -89,6 +90,15 @@ private:
 	GLuint _vao;
 	GLuint _program;
 	GLuint _vertex_buffer;
+
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint screen_space = -1;
+		GLint color = -1;
+		GLint position = -1;
+		GLint width = -1;
+		GLint height = -1;
+	} _uniforms;
 };
 
 /********************************************************************************************************************************************************/
@@ -132,6 +142,15 @@ private:
 	GLuint _program;
 	GLuint _vertex_buffer;
 
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint viewport = -1;
+		GLint color = -1;
+		GLint position = -1;
+		GLint width = -1;
+		GLint height = -1;
+	} _uniforms;
+
 	std::vector<glm::vec2> _vertex_data;
 };
 
@@ -152,6 +171,17 @@ private:
 	GLuint _vertex_buffer;
 
 	GLuint _font_atlas;
+
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint screen_space = -1;
+		GLint scale = -1;
+		GLint color = -1;
+		GLint position = -1;
+		GLint text_width = -1;
+		GLint text_height = -1;
+		GLint text_position = -1;
+	} _uniforms;
 };
 
 /********************************************************************************************************************************************************/
@@ -168,6 +198,15 @@ private:
 	GLuint _vao;
 	GLuint _vertex_buffer;
 	GLuint _program;
+
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint screen_space = -1;
+		GLint highlight = -1;
+		GLint width = -1;
+		GLint height = -1;
+		GLint position = -1;
+	} _uniforms;
 };
 
 /********************************************************************************************************************************************************/
@@ -1,13 +1,17 @@
 #include "Mesh.h"
 
+#include <algorithm>
+
 #define VIEW_SHADER 7
 
 const glm::mat4 VIEW_PROJECTION = glm::ortho(0, 1, 0, 1);
 
-Mesh::Mesh() {
-}
+Mesh::Mesh() :
+	_buffer			( nullptr )
+{}
 
 Mesh::Mesh(
+	MeshBuffer& buffer,
 	const std::vector<Texture>& textures,
 	const std::vector<glm::vec3>& vertices,
 	const std::vector<glm::vec2>& uvs,
@@ -18,9 +22,10 @@ Mesh::Mesh(
 	_vertices			( vertices ),
 	_uvs				( uvs ),
 	_normals			( normals ),
-	_indices			( indices )
+	_indices			( indices ),
+	_buffer				( nullptr )
 {
-	load_buffers();
+	load_buffers(buffer);
 }
 
 Mesh::Mesh(const Mesh& rhs) :
@@ -29,11 +34,8 @@ Mesh::Mesh(const Mesh& rhs) :
 	_uvs			( rhs._uvs ),
 	_normals		( rhs._normals ),
 	_indices		( rhs._indices ),
-	_vao			( rhs._vao ),
-	_vertex_buffer  ( rhs._vertex_buffer ),
-	_uv_buffer		( rhs._uv_buffer ),
-	_normal_buffer  ( rhs._normal_buffer ),
-	_indices_buffer ( rhs._indices_buffer )
+	_buffer			( rhs._buffer ),
+	_range			( rhs._range )
 {}
 
 Mesh::Mesh(Mesh&& rhs) noexcept :
@@ -42,73 +44,54 @@ Mesh::Mesh(Mesh&& rhs) noexcept :
 	_uvs			( std::move(rhs._uvs) ),
 	_normals		( std::move(rhs._normals) ),
 	_indices		( std::move(rhs._indices) ),
-	_vao			( rhs._vao ),
-	_vertex_buffer	( rhs._vertex_buffer ),
-	_uv_buffer		( rhs._uv_buffer ),
-	_normal_buffer	( rhs._normal_buffer ),
-	_indices_buffer	( rhs._indices_buffer )
+	_buffer			( rhs._buffer ),
+	_range			( rhs._range )
 {}
 
 Mesh::~Mesh() {
 }
 
-void Mesh::delete_vao() {
-	glDeleteVertexArrays(1, &_vao);
-	glDeleteBuffers(1, &_vertex_buffer);
-	glDeleteBuffers(1, &_uv_buffer);
-	glDeleteBuffers(1, &_normal_buffer);
-	glDeleteBuffers(1, &_indices_buffer);
-
+// the geometry lives as long as the MeshBuffer -- only the textures are the mesh's own
+void Mesh::delete_textures() {
 	for (auto& texture : _textures) {
 		texture.delete_texture();
 	}
 }
 
-void Mesh::load_buffers() {
-	glCreateVertexArrays(1, &_vao);
-	glBindVertexArray(_vao);
+void Mesh::load_buffers(MeshBuffer& buffer) {
+	_buffer = &buffer;
+	_range = buffer.add(_vertices, _uvs, _normals, _indices);
+}
 
-	glCreateBuffers(1, &_vertex_buffer);
-	if (_vertices.size() > 0) {
-		glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
-		glNamedBufferStorage(_vertex_buffer, sizeof(glm::vec3) * _vertices.size(), &_vertices[0], 0);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	}
+// one at a time -- for programs that take the model matrix as a uniform
+void Mesh::draw(const GLuint program, GLint model_location, Transform& transform, int mode) {
+	_buffer->bind();
+	glUseProgram(program);
 
-	glCreateBuffers(1, &_uv_buffer);
-	if (_uvs.size() > 0) {
-		glBindBuffer(GL_ARRAY_BUFFER, _uv_buffer);
-		glNamedBufferStorage(_uv_buffer, sizeof(glm::vec2) * _uvs.size(), &_uvs[0], 0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	}
+	glUniformMatrix4fv(model_location, 1, GL_FALSE, &transform.get_model()[0][0]);
 
-	glCreateBuffers(1, &_normal_buffer);
-	if (_normals.size() > 0) {
-		glBindBuffer(GL_ARRAY_BUFFER, _normal_buffer);
-		glNamedBufferStorage(_normal_buffer, sizeof(glm::vec3) * _normals.size(), &_normals[0], 0);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	}
+	bind_textures();
 
-	glCreateBuffers(1, &_indices_buffer);
-	if (_indices.size() > 0) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indices_buffer);
-		glNamedBufferStorage(_indices_buffer, sizeof(unsigned short) * _indices.size(), &_indices[0], 0);
-	}
+	glDrawElementsBaseVertex(mode, _range.index_count, GL_UNSIGNED_SHORT, (void*)(_range.first_index * sizeof(unsigned short)), _range.base_vertex);
 }
 
-void Mesh::draw(const GLuint program, Transform& transform, int mode) {
-	glBindVertexArray(_vao);
-	glUseProgram(program);
-
-	glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, &transform.get_model()[0][0]);
+DrawElementsCommand Mesh::command(GLuint instance_count, GLuint base_instance) {
+	return { _range.index_count, instance_count, _range.first_index, _range.base_vertex, base_instance };
+}
 
+void Mesh::bind_textures() {
 	for (unsigned int i = 0; i < _textures.size(); ++i) {
 		glActiveTexture(GL_TEXTURE0 + i);
 		glBindTexture(GL_TEXTURE_2D, _textures[i]._id);
 	}
+}
+
+bool Mesh::same_textures(const Mesh& rhs) const {
+	return std::equal(_textures.begin(), _textures.end(), rhs._textures.begin(), rhs._textures.end(),
+		[](const Texture& a, const Texture& b) { return a._id == b._id; });
+}
 
-	glDrawElements(mode, _indices.size(), GL_UNSIGNED_SHORT, (void*)0);
-}
\ No newline at end of file
+bool Mesh::textures_less(const Mesh& rhs) const {
+	return std::lexicographical_compare(_textures.begin(), _textures.end(), rhs._textures.begin(), rhs._textures.end(),
+		[](const Texture& a, const Texture& b) { return a._id < b._id; });
+}
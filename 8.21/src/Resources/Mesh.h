@@ -7,11 +7,13 @@
 
 #include "Transform.h"
 #include "Texture.h"
+#include "MeshBuffer.h"
 
 class Mesh {
 public:
 	Mesh();
 	Mesh(
+		MeshBuffer& buffer,
 		const std::vector<Texture>& textures,
 		const std::vector<glm::vec3>& vertices,
 		const std::vector<glm::vec2>& uvs,
@@ -22,11 +24,20 @@ public:
 	Mesh(Mesh&& rhs) noexcept;
 	~Mesh();
 
-	void load_buffers();
+	// copies the vertices into buffer -- the mesh is drawn from there
+	void load_buffers(MeshBuffer& buffer);
 	void update_buffers();
-	void draw(const GLuint program, Transform& transform, int mode = GL_TRIANGLES);
+	// model_location is where program takes the model matrix -- see Program::uniform()
+	void draw(const GLuint program, GLint model_location, Transform& transform, int mode = GL_TRIANGLES);
 
-	void delete_vao();
+	// instance_count instances of the mesh reading matrices from base_instance on
+	DrawElementsCommand command(GLuint instance_count, GLuint base_instance);
+	void bind_textures();
+	// meshes that bind the same textures can share a multi draw
+	bool same_textures(const Mesh& rhs) const;
+	bool textures_less(const Mesh& rhs) const;
+
+	void delete_textures();
 public:
 	std::vector<Texture>        _textures;
 	std::vector<glm::vec3>      _vertices;
@@ -34,13 +45,8 @@ public:
 	std::vector<glm::vec3>      _normals;
 	std::vector<unsigned short> _indices;
 private:
-	void prepare_draw(const GLuint program, Transform& transform);
-private:
-	GLuint  _vao,
-			_vertex_buffer,
-			_uv_buffer,
-			_normal_buffer,
-			_indices_buffer;
+	MeshBuffer* _buffer;
+	MeshRange _range;
 };
 
-#endif
\ No newline at end of file
+#endif
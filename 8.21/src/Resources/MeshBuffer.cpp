@@ -0,0 +1,111 @@
+#include "MeshBuffer.h"
+
+#include <cstddef>
+
+MeshBuffer::MeshBuffer() :
+	_vao				( 0 ),
+	_vertex_buffer		( 0 ),
+	_index_buffer		( 0 ),
+	_instance_buffer	( 0 ),
+	_indirect_buffer	( 0 ),
+	_created			( false ),
+	_dirty				( false )
+{}
+
+MeshBuffer::~MeshBuffer() {
+	if (!_created) {
+		return;
+	}
+
+	glDeleteVertexArrays(1, &_vao);
+	glDeleteBuffers(1, &_vertex_buffer);
+	glDeleteBuffers(1, &_index_buffer);
+	glDeleteBuffers(1, &_instance_buffer);
+	glDeleteBuffers(1, &_indirect_buffer);
+}
+
+// meshes without uvs or normals get zeros -- every vertex has the same layout
+MeshRange MeshBuffer::add(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec2>& uvs, const std::vector<glm::vec3>& normals, const std::vector<unsigned short>& indices) {
+	MeshRange range;
+	range.first_index = (GLuint)_indices.size();
+	range.index_count = (GLuint)indices.size();
+	range.base_vertex = (GLint)_vertices.size();
+
+	_vertices.reserve(_vertices.size() + vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i) {
+		_vertices.push_back({
+			vertices[i],
+			i < uvs.size() ? uvs[i] : glm::vec2(0.0f),
+			i < normals.size() ? normals[i] : glm::vec3(0.0f)
+		});
+	}
+
+	_indices.insert(_indices.end(), indices.begin(), indices.end());
+	_dirty = true;
+
+	return range;
+}
+
+void MeshBuffer::bind() {
+	if (!_created) {
+		create();
+	}
+
+	if (_dirty) {
+		upload();
+	}
+
+	glBindVertexArray(_vao);
+}
+
+void MeshBuffer::set_instances(const std::vector<glm::mat4>& models) {
+	glNamedBufferData(_instance_buffer, sizeof(glm::mat4) * models.size(), models.data(), GL_STREAM_DRAW);
+}
+
+void MeshBuffer::set_commands(const std::vector<DrawElementsCommand>& commands) {
+	glNamedBufferData(_indirect_buffer, sizeof(DrawElementsCommand) * commands.size(), commands.data(), GL_STREAM_DRAW);
+}
+
+void MeshBuffer::multi_draw(int first, int count, int mode) {
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+	glMultiDrawElementsIndirect(mode, GL_UNSIGNED_SHORT, (void*)(first * sizeof(DrawElementsCommand)), count, 0);
+}
+
+// attributes 0 - 2 are the vertex, 3 - 6 the instance's model matrix one column each
+void MeshBuffer::create() {
+	glCreateVertexArrays(1, &_vao);
+	glCreateBuffers(1, &_vertex_buffer);
+	glCreateBuffers(1, &_index_buffer);
+	glCreateBuffers(1, &_instance_buffer);
+	glCreateBuffers(1, &_indirect_buffer);
+
+	glVertexArrayVertexBuffer(_vao, MESH_VERTEX_BINDING, _vertex_buffer, 0, sizeof(MeshVertex));
+	glVertexArrayElementBuffer(_vao, _index_buffer);
+
+	const GLuint offsets[3] = { offsetof(MeshVertex, position), offsetof(MeshVertex, uv), offsetof(MeshVertex, normal) };
+	const GLint sizes[3] = { 3, 2, 3 };
+	for (GLuint i = 0; i < 3; ++i) {
+		glEnableVertexArrayAttrib(_vao, i);
+		glVertexArrayAttribFormat(_vao, i, sizes[i], GL_FLOAT, GL_FALSE, offsets[i]);
+		glVertexArrayAttribBinding(_vao, i, MESH_VERTEX_BINDING);
+	}
+
+	glVertexArrayVertexBuffer(_vao, MESH_INSTANCE_BINDING, _instance_buffer, 0, sizeof(glm::mat4));
+	glVertexArrayBindingDivisor(_vao, MESH_INSTANCE_BINDING, 1);
+	for (GLuint i = 0; i < 4; ++i) {
+		const GLuint attribute = MESH_INSTANCE_ATTRIBUTE + i;
+		glEnableVertexArrayAttrib(_vao, attribute);
+		glVertexArrayAttribFormat(_vao, attribute, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4) * i);
+		glVertexArrayAttribBinding(_vao, attribute, MESH_INSTANCE_BINDING);
+	}
+
+	_created = true;
+}
+
+// meshes are only added while models load so the whole buffer is simply replaced
+void MeshBuffer::upload() {
+	glNamedBufferData(_vertex_buffer, sizeof(MeshVertex) * _vertices.size(), _vertices.data(), GL_STATIC_DRAW);
+	glNamedBufferData(_index_buffer, sizeof(unsigned short) * _indices.size(), _indices.data(), GL_STATIC_DRAW);
+
+	_dirty = false;
+}
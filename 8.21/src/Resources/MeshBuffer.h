@@ -0,0 +1,73 @@
+#ifndef MESH_BUFFER_H
+#define MESH_BUFFER_H
+
+#include <GL/gl3w.h>
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// mat4 model per instance takes attributes 3 - 6 -- fed from vertex buffer binding 1
+#define MESH_INSTANCE_ATTRIBUTE 3
+#define MESH_VERTEX_BINDING 0
+#define MESH_INSTANCE_BINDING 1
+
+struct MeshVertex {
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec3 normal;
+};
+
+// where a mesh sits in the shared buffers -- counted in indices / vertices, not bytes
+struct MeshRange {
+	GLuint first_index = 0;
+	GLuint index_count = 0;
+	GLint base_vertex = 0;
+};
+
+// laid out the way glMultiDrawElementsIndirect reads it
+struct DrawElementsCommand {
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
+// Every mesh's vertices interleaved in one buffer and its indices in another, behind one vao
+// instances and draw commands for a frame go in two more buffers so a whole pass can be one indirect call per material
+class MeshBuffer {
+public:
+	MeshBuffer();
+	~MeshBuffer();
+
+	// copied -- reaches the gpu on the next bind()
+	MeshRange add(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec2>& uvs, const std::vector<glm::vec3>& normals, const std::vector<unsigned short>& indices);
+
+	void bind();
+
+	// both are orphaned every call so the driver never waits on last frame's draws
+	void set_instances(const std::vector<glm::mat4>& models);
+	void set_commands(const std::vector<DrawElementsCommand>& commands);
+
+	// count commands from first in the buffer given to set_commands()
+	void multi_draw(int first, int count, int mode = GL_TRIANGLES);
+private:
+	void create();
+	void upload();
+
+	GLuint _vao;
+	GLuint _vertex_buffer;
+	GLuint _index_buffer;
+	GLuint _instance_buffer;
+	GLuint _indirect_buffer;
+
+	// kept so later meshes can be added without reading the buffers back
+	std::vector<MeshVertex> _vertices;
+	std::vector<unsigned short> _indices;
+
+	bool _created;
+	bool _dirty;
+};
+
+#endif
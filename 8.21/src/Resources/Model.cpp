@@ -26,53 +26,104 @@ ReadModelFile::ReadModelFile(const char* file_path) {
 
 Model::Model() :
 	_id				( 0 ),
-	_program		( 0 )
+	_headless		( false ),
+	_program		( 0 ),
+	_instanced		( false ),
+	_model_location	( -1 )
 {}
 
 Model::Model(std::shared_ptr<Program> program, std::string_view directory, std::string_view model_file) :
 	_id				( 0 ),
-	_program		( program )
+	_headless		( false ),
+	_program		( program ),
+	_instanced		( false ),
+	_model_location	( -1 )
 {
 	load_assimp(directory, model_file);
 	make_collision_box();
+	find_instancing();
 }
 
 Model::Model(int id, std::string_view file_path) :
-	_id				( id )
+	_id				( id ),
+	_headless		( Environment::get().get_mode() == MODE_SERVER ),
+	_instanced		( false ),
+	_model_location	( -1 )
 {
 	load_from_file(file_path.data());
 	make_collision_box();
+	find_instancing();
+
+	// server only needs the bounds -- drop the cpu copy of the vertices
+	if (_headless) {
+		_meshes.clear();
+		_meshes.shrink_to_fit();
+	}
 }
 
 Model::Model(const Model& rhs) :
 	_id				( rhs._id ),
+	_headless		( rhs._headless ),
 	_program		( rhs._program ),
 	_meshes			( rhs._meshes ),
-	_collision_box	( rhs._collision_box )
+	_collision_box	( rhs._collision_box ),
+	_instanced		( rhs._instanced ),
+	_model_location	( rhs._model_location )
 {}
 
 Model::~Model() {
+	if (_headless) {
+		return;
+	}
+
 	for(auto& mesh : _meshes) {
-		mesh.delete_vao();
+		mesh.delete_textures();
 	}
 }
 
 void Model::draw(Transform& transform) {
 	for(auto& mesh : _meshes) {
-		mesh.draw(_program->_id, transform);
+		mesh.draw(_program->_id, _model_location, transform);
 	}
 }
 
-void Model::draw(Transform& transform, GLuint program) {
+void Model::draw(Transform& transform, const Program& program) {
+	const GLint model_location = program.uniform("model");
 	for (auto& mesh : _meshes) {
-		mesh.draw(program, transform);
+		mesh.draw(program._id, model_location, transform);
 	}
 }
 
+bool Model::is_instanced() {
+	return _instanced;
+}
+
+void Model::add_instance(const glm::mat4& model) {
+	_instances.push_back(model);
+}
+
+std::vector<glm::mat4>& Model::get_instances() {
+	return _instances;
+}
+
+std::vector<Mesh>& Model::get_meshes() {
+	return _meshes;
+}
+
+// only programs with a per instance model attribute -- the rest keep drawing one at a time with the uniform
+void Model::find_instancing() {
+	_instanced = !_headless && _program && glGetAttribLocation(_program->_id, "model") == MESH_INSTANCE_ATTRIBUTE;
+	_model_location = !_headless && _program ? _program->uniform("model") : -1;
+}
+
 bool Model::load_from_file(const char* file_path) {
 	ReadModelFile model_file(file_path);
 	bool loaded = false;
 
+	if (_headless) {
+		return load_bounds(model_file._directory, model_file._file);
+	}
+
 	loaded = load_assimp(model_file._directory, model_file._file);
 
 	_program = Environment::get().get_resource_manager()->get_program(model_file._program_key);
@@ -93,7 +144,7 @@ void load_material_textures(std::vector<Texture>& textures, aiMaterial* material
 		material->GetTexture(type, i, &string);
 
 		std::string path(string.C_Str());
-		size_t end = path.find_last_of('\\') + 1;
+		size_t end = path.find_last_of("\\/") + 1;
 		path.erase(0, end);
 		path.insert(0, directory);
 		std::cout << "Texture Path: " << path << '\n';
@@ -128,6 +179,8 @@ bool Model::load_assimp(std::string_view directory, std::string_view model_file)
 		return false;
 	}
 
+	MeshBuffer& mesh_buffer = *Environment::get().get_resource_manager()->get_mesh_buffer();
+
 	const aiMesh* ai_mesh = scene->mMeshes[0];
 	std::cout << "Meshes: " << scene->mNumMeshes << '\n';
 	std::cout << "Materials: " << scene->mNumMaterials << '\n';
@@ -159,7 +212,7 @@ bool Model::load_assimp(std::string_view directory, std::string_view model_file)
 			mesh._indices.push_back(ai_mesh->mFaces[i].mIndices[2]);
 		}
 
-		mesh.load_buffers();
+		mesh.load_buffers(mesh_buffer);
 
 		if (ai_mesh->mMaterialIndex >= 0) {
 			aiMaterial* material = scene->mMaterials[ai_mesh->mMaterialIndex];
@@ -177,6 +230,38 @@ bool Model::load_assimp(std::string_view directory, std::string_view model_file)
 	return true;
 }
 
+// Headless (server) load -- only reads vertex positions for make_collision_box()
+// no buffers, textures or programs are created so no GL context is needed
+bool Model::load_bounds(std::string_view directory, std::string_view model_file) {
+	Assimp::Importer importer;
+	std::string path;
+	path.reserve(directory.size() + model_file.size());
+	path.append(directory);
+	path.append(model_file);
+
+	// no post processing -- positions are all that's used
+	const aiScene* scene = importer.ReadFile(path, 0);
+	if (!scene) {
+		std::cout << "Assimp Loader -- Couldn't load scene at -- " << path << '\n';
+		std::cout << importer.GetErrorString();
+		return false;
+	}
+
+	for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+		Mesh mesh;
+		const aiMesh* ai_mesh = scene->mMeshes[i];
+		mesh._vertices.reserve(ai_mesh->mNumVertices);
+		for (unsigned int i = 0; i < ai_mesh->mNumVertices; ++i) {
+			aiVector3D pos = ai_mesh->mVertices[i];
+			mesh._vertices.push_back(glm::vec3(pos.x, pos.y, pos.z));
+		}
+
+		_meshes.push_back(std::move(mesh));
+	}
+
+	return true;
+}
+
 CollisionBox Model::get_collision_box() {
 	return _collision_box;
 }
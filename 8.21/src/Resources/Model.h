@@ -32,7 +32,14 @@ public:
 	~Model();
 
 	void draw(Transform& transform);
-	void draw(Transform& transform, GLuint program);
+	void draw(Transform& transform, const Program& program);
+
+	// its program takes the model matrix per instance -- see MESH_INSTANCE_ATTRIBUTE
+	bool is_instanced();
+	// queued for ModelManager::draw_models() -- which clears them
+	void add_instance(const glm::mat4& model);
+	std::vector<glm::mat4>& get_instances();
+	std::vector<Mesh>& get_meshes();
 
 	CollisionBox get_collision_box();
 	void make_collision_box();
@@ -41,11 +48,20 @@ public:
 private:
 	bool load_from_file(const char* file_path);
 	bool load_assimp(std::string_view directory, std::string_view path);
+	bool load_bounds(std::string_view directory, std::string_view path);
+	void find_instancing();
 private:
 	int _id;
+	bool _headless;
 	std::shared_ptr<Program> _program;
 	std::vector<Mesh> _meshes;
 	CollisionBox _collision_box;
+
+	bool _instanced;
+	std::vector<glm::mat4> _instances;
+
+	// its program's model uniform -- -1 when instanced, the matrix is an attribute then
+	GLint _model_location;
 };
 
 #endif
\ No newline at end of file
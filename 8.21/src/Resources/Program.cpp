@@ -38,6 +38,43 @@ void Program::load_from_file(const char* file_path) {
 
 	_id = load_shaders(program);
 	_name = program_file._name;
+
+	reflect_uniforms();
+}
+
+// arrays are reported as name[0] -- kept under their plain name too
+// uniforms inside a block have no location and are skipped
+void Program::reflect_uniforms() {
+	GLint count = 0;
+	GLint max_length = 0;
+	glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+	std::vector<GLchar> name(max_length + 1);
+	for (GLint i = 0; i < count; ++i) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(_id, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+		const std::string uniform_name(name.data(), length);
+		const GLint location = glGetUniformLocation(_id, uniform_name.c_str());
+		if (location == -1) {
+			continue;
+		}
+
+		_uniforms[uniform_name] = location;
+
+		const size_t bracket = uniform_name.find('[');
+		if (bracket != std::string::npos) {
+			_uniforms[uniform_name.substr(0, bracket)] = location;
+		}
+	}
+}
+
+GLint Program::uniform(const std::string& name) const {
+	const auto it = _uniforms.find(name);
+	return it != _uniforms.end() ? it->second : -1;
 }
 
 GLuint load_shaders(const ShaderInfo* program) {
@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 
 #include <string>
+#include <unordered_map>
 
 struct ShaderInfo {
 	unsigned short _type;
@@ -31,11 +32,18 @@ struct Program {
 	Program(int key, const char* file_path);
 	~Program();
 
+	// -1 when the program has no active uniform by that name -- look it up once and keep the location
+	GLint uniform(const std::string& name) const;
+
 	int			 _key;
 	std::string  _name;
 	GLuint		 _id;
 private:
 	void load_from_file(const char* file_path);
+	// every active uniform's location, read once after linking so drawing never asks the driver by name
+	void reflect_uniforms();
+
+	std::unordered_map<std::string, GLint> _uniforms;
 };
 
 #endif
\ No newline at end of file
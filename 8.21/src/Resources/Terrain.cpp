@@ -5,13 +5,26 @@
 #include "../src/System/Environment.h"
 #include "../src/System/ResourceManager.h"
 #include "../src/Resources/Program.h"
+#include "../src/Utility/Pathfinder.h"
+#include "../src/Utility/Frustum.h"
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TERRAIN_SSE
+#endif
 
 #define TERRAIN_SHADER_ID 1
 #define TILE_SELECITON_SHADER_ID 7
 
+// heights a mouse ray is checked at per exact_heights() call
+#define TERRAIN_RAY_BATCH 16
+
 /********************************************************************************************************************************************************/
 
 TerrainData::TerrainData(int width, int length, float tile_width, float tile_length) :
@@ -21,6 +34,7 @@ TerrainData::TerrainData(int width, int length, float tile_width, float tile_len
 	_tile_length		( tile_length )
 {
 	_height_map.resize(width * length);
+	_planes.resize(width * length);
 }
 
 TerrainData::TerrainData(TerrainData&& terrain_data) noexcept :
@@ -28,7 +42,8 @@ TerrainData::TerrainData(TerrainData&& terrain_data) noexcept :
 	_length				( std::move(terrain_data._length) ),
 	_tile_width			( std::move(terrain_data._tile_width) ),
 	_tile_length		( std::move(terrain_data._tile_length) ),
-	_height_map			( std::move(terrain_data._height_map) )
+	_height_map			( std::move(terrain_data._height_map) ),
+	_planes				( std::move(terrain_data._planes) )
 {}
 
 TerrainData::TerrainData() :
@@ -68,6 +83,171 @@ void TerrainData::load(FileReader& file) {
 	for(int i = 0; i < _height_map.size(); ++i) {
 		ss_height_map >> _height_map[i].height[0] >> _height_map[i].height[1] >> _height_map[i].height[2] >> _height_map[i].height[3];
 	}
+
+	update_planes();
+}
+
+// x, z in tiles
+float TerrainData::exact_height(float x, float z) {
+	if(x < 0.0f || x >= _width || z < 0.0f || z >= _length) {
+		return 0.0f;
+	}
+
+	const int tile_x = (int)x;
+	const int tile_z = (int)z;
+	const TilePlane& plane = _planes[tile_z * _width + tile_x];
+
+	return plane.base + plane.slope_x * (x - tile_x) + plane.slope_z * (z - tile_z);
+}
+
+// four at a time -- the planes are loaded one by one, SSE2 has no gather
+void TerrainData::exact_heights(const float* x, const float* z, float* y, int count) {
+	int i = 0;
+
+#ifdef TERRAIN_SSE
+	if (!_planes.empty()) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 width = _mm_set1_ps((float)_width);
+		const __m128 length = _mm_set1_ps((float)_length);
+
+		alignas(16) int tile_x[4];
+		alignas(16) int tile_z[4];
+		alignas(16) float base[4];
+		alignas(16) float slope_x[4];
+		alignas(16) float slope_z[4];
+
+		for (; i + 4 <= count; i += 4) {
+			const __m128 px = _mm_loadu_ps(x + i);
+			const __m128 pz = _mm_loadu_ps(z + i);
+
+			const __m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(px, zero), _mm_cmplt_ps(px, width)),
+				_mm_and_ps(_mm_cmpge_ps(pz, zero), _mm_cmplt_ps(pz, length)));
+
+			// truncating is flooring on the map
+			const __m128i tx = _mm_cvttps_epi32(px);
+			const __m128i tz = _mm_cvttps_epi32(pz);
+			_mm_store_si128((__m128i*)tile_x, tx);
+			_mm_store_si128((__m128i*)tile_z, tz);
+
+			// lanes off the map read tile 0 and are zeroed below
+			const int mask = _mm_movemask_ps(inside);
+			for (int lane = 0; lane < 4; ++lane) {
+				const TilePlane& plane = _planes[(mask >> lane) & 1 ? tile_z[lane] * _width + tile_x[lane] : 0];
+				base[lane] = plane.base;
+				slope_x[lane] = plane.slope_x;
+				slope_z[lane] = plane.slope_z;
+			}
+
+			const __m128 fx = _mm_sub_ps(px, _mm_cvtepi32_ps(tx));
+			const __m128 fz = _mm_sub_ps(pz, _mm_cvtepi32_ps(tz));
+
+			const __m128 height = _mm_add_ps(_mm_load_ps(base),
+				_mm_add_ps(_mm_mul_ps(_mm_load_ps(slope_x), fx), _mm_mul_ps(_mm_load_ps(slope_z), fz)));
+
+			_mm_storeu_ps(y + i, _mm_and_ps(height, inside));
+		}
+	}
+#endif
+
+	for (; i < count; ++i) {
+		y[i] = exact_height(x[i], z[i]);
+	}
+}
+
+// a ramp is min height plus the rise along each axis it slopes on -- falling slopes start from the top
+void TerrainData::update_plane(int index) {
+	TileHeight& tile = _height_map[index];
+	TilePlane& plane = _planes[index];
+
+	if (tile.is_flat()) {
+		plane = { tile.height[0], 0.0f, 0.0f };
+		return;
+	}
+
+	const float width_y = tile.height[1] - tile.height[0];
+	const float length_y = tile.height[2] - tile.height[0];
+	const float min_height = tile.min_height();
+
+	plane.slope_x = width_y;
+	plane.slope_z = length_y;
+	plane.base = 0.0f;
+
+	if (width_y != 0.0f) {
+		plane.base += min_height + (width_y < 0.0f ? -width_y : 0.0f);
+	}
+	if (length_y != 0.0f) {
+		plane.base += min_height + (length_y < 0.0f ? -length_y : 0.0f);
+	}
+}
+
+void TerrainData::update_planes() {
+	_planes.resize(_height_map.size());
+	for (int i = 0; i < (int)_height_map.size(); ++i) {
+		update_plane(i);
+	}
+}
+
+bool TerrainData::is_walkable(int x, int z) {
+	if (x < 0 || x >= _width || z < 0 || z >= _length) {
+		return false;
+	}
+
+	const GLfloat* h = _height_map[z * _width + x].height;
+
+	const bool ramp_x = h[0] == h[2] && h[1] == h[3];
+	const bool ramp_z = h[0] == h[1] && h[2] == h[3];
+	if (!ramp_x && !ramp_z) {
+		return false;
+	}
+
+	// a step between tiles is a cliff on both sides
+	if (x > 0) {
+		const GLfloat* left = _height_map[z * _width + x - 1].height;
+		if (left[1] != h[0] || left[3] != h[2]) {
+			return false;
+		}
+	}
+	if (x < _width - 1) {
+		const GLfloat* right = _height_map[z * _width + x + 1].height;
+		if (right[0] != h[1] || right[2] != h[3]) {
+			return false;
+		}
+	}
+	if (z > 0) {
+		const GLfloat* top = _height_map[(z - 1) * _width + x].height;
+		if (top[2] != h[0] || top[3] != h[1]) {
+			return false;
+		}
+	}
+	if (z < _length - 1) {
+		const GLfloat* bottom = _height_map[(z + 1) * _width + x].height;
+		if (bottom[0] != h[2] || bottom[1] != h[3]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+float TerrainData::get_world_size() {
+	return std::max(_width * _tile_width, _length * _tile_length);
+}
+
+int TerrainData::get_width() {
+	return _width;
+}
+
+int TerrainData::get_length() {
+	return _length;
+}
+
+float TerrainData::get_tile_width() {
+	return _tile_width;
+}
+
+float TerrainData::get_tile_length() {
+	return _tile_length;
 }
 
 /********************************************************************************************************************************************************/
@@ -99,10 +279,14 @@ void TileSelection::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(TILE_SELECITON_SHADER_ID)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(TILE_SELECITON_SHADER_ID);
+	_program = program->_id;
+	_uniforms.model = program->uniform("model");
+	_uniforms.color = program->uniform("color");
+
 	glUseProgram(_program);
 
-	glUniformMatrix4fv(glGetUniformLocation(_program, "model"), 1, GL_FALSE, &_transform.get_model()[0][0]);
+	glUniformMatrix4fv(_uniforms.model, 1, GL_FALSE, &_transform.get_model()[0][0]);
 
 	glCreateBuffers(1, &_vertex_buffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _vertex_buffer);
@@ -116,7 +300,7 @@ void TileSelection::update_vao() {
 
 	_transform.set_position(glm::vec3(_x * _tile_width, 0.f, _z * _tile_length));
 	glUseProgram(_program);
-	glUniformMatrix4fv(glGetUniformLocation(_program, "model"), 1, GL_FALSE, &_transform.get_model()[0][0]);
+	glUniformMatrix4fv(_uniforms.model, 1, GL_FALSE, &_transform.get_model()[0][0]);
 
 	_vertex_data[0].y = _height_map[_index].height[1] + 0.01f;;
 	_vertex_data[1].y = _height_map[_index].height[0] + 0.01f;;
@@ -152,8 +336,8 @@ void TileSelection::draw() {
 	glBindVertexArray(_vao);
 	glUseProgram(_program);
 
-	glUniformMatrix4fv(glGetUniformLocation(_program, "model"), 1, GL_FALSE, &_transform.get_model()[0][0]);
-	glUniform4fv(glGetUniformLocation(_program, "color"), 1, &_color[0]);
+	glUniformMatrix4fv(_uniforms.model, 1, GL_FALSE, &_transform.get_model()[0][0]);
+	glUniform4fv(_uniforms.color, 1, &_color[0]);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -180,12 +364,7 @@ bool TileSelection::is_valid_tile() {
 }
 
 bool TileSelection::select(glm::vec3 world_space, glm::vec3 position) {
-	float height = position.y;
-	const float increment = height > 1.0f ? height * 0.01f : 0.01f;
-
-	while (above_terrain(world_space, position, height)) {
-		height -= increment;
-	}
+	const float height = ray_height(world_space, position);
 
 	const float y = abs((position.y - height) / world_space.y);
 	const float x = (y * world_space.x + position.x) / _tile_width;
@@ -200,12 +379,7 @@ bool TileSelection::select(glm::vec3 world_space, glm::vec3 position) {
 }
 
 glm::vec3 TileSelection::get_select_position(glm::vec3 world_space, glm::vec3 offset) {
-	float height = offset.y;
-	const float increment = height > 1.0f ? height * 0.01f : 0.01f;
-
-	while (above_terrain(world_space, offset, height)) {
-		height -= increment;
-	}
+	const float height = ray_height(world_space, offset);
 
 	const float y = abs((offset.y - height) / world_space.y);
 	const float x = (y * world_space.x + offset.x) / _tile_width;
@@ -214,61 +388,34 @@ glm::vec3 TileSelection::get_select_position(glm::vec3 world_space, glm::vec3 of
 	return glm::vec3(x, y, z);
 }
 
-bool TileSelection::above_terrain(glm::vec3 world_space, glm::vec3 position, float height) {
-	const float y = abs((position.y - height) / world_space.y);
-	const float x = (y * world_space.x + position.x) / _tile_width;
-	const float z = (y * world_space.z + position.z) / _tile_length;
-
-	const float terrain_height = exact_height(x, z);
-
-	if(height > terrain_height) {
-		return true;
-	}
-
-	return false;
-}
-
-float TileSelection::exact_height(float x, float z) {
-	if(x < 0.0f || x >= _width || z < 0.0f || z >= _length) {
-		return 0.0f;
-	}
-
-	const int index = (int)z * _width + (int)x;
-	if(_height_map[index].is_flat()) {
-		return _height_map[index].height[0];
-	}
+// steps down from position.y until the ray is no longer above the terrain -- TERRAIN_RAY_BATCH steps per exact_heights()
+float TileSelection::ray_height(glm::vec3 world_space, glm::vec3 position) {
+	float height = position.y;
+	const float increment = height > 1.0f ? height * 0.01f : 0.01f;
 
-	const float width_y = _height_map[index].height[1] - _height_map[index].height[0];
-	const float length_y = _height_map[index].height[2] - _height_map[index].height[0];
-	const float min_height = _height_map[index].min_height();
+	float heights[TERRAIN_RAY_BATCH];
+	float x[TERRAIN_RAY_BATCH];
+	float z[TERRAIN_RAY_BATCH];
+	float terrain_heights[TERRAIN_RAY_BATCH];
 
-	const bool left_to_right = width_y > 0.0f;
-	const bool bottom_to_top = length_y > 0.0f;
+	while (true) {
+		for (int i = 0; i < TERRAIN_RAY_BATCH; ++i) {
+			const float y = abs((position.y - height) / world_space.y);
+			x[i] = (y * world_space.x + position.x) / _tile_width;
+			z[i] = (y * world_space.z + position.z) / _tile_length;
 
-	float height_x = 0.0f;
-	float height_z = 0.0f;
-	if(!left_to_right) {
-		height_x = (1.0f - (float(x - int(x)))) * abs(width_y);
-	}
-	else {
-		height_x = (float(x - int(x))) * abs(width_y);
-	}
+			heights[i] = height;
+			height -= increment;
+		}
 
-	if(!bottom_to_top) {
-		height_z = (1.0f - (float(z - int(z)))) * abs(length_y);
-	}
-	else {
-		height_z = (float(z - int(z))) * abs(length_y);
-	}
+		exact_heights(x, z, terrain_heights, TERRAIN_RAY_BATCH);
 
-	if(width_y != 0) {
-		height_x += min_height;
+		for (int i = 0; i < TERRAIN_RAY_BATCH; ++i) {
+			if (!(heights[i] > terrain_heights[i])) {
+				return heights[i];
+			}
+		}
 	}
-	if(length_y != 0) {
-		height_z += min_height;
-	};
-
-	return height_x + height_z;;
 }
 
 glm::vec2 TileSelection::get_selected_tile() {
@@ -399,7 +546,7 @@ float TerrainEntityPlacement::entity_tile_height(int index, int position, bool*
 			const auto h1 = _height_map[i1].min_height();
 			const auto h2 = _height_map[i2].min_height();
 
-			height = max(h1, h2);
+			height = std::max(h1, h2);
 
 			const auto t1 = _height_map[i1].height;
 			const auto t2 = _height_map[i2].height;
@@ -427,19 +574,19 @@ float TerrainEntityPlacement::entity_tile_height(int index, int position, bool*
 			t2 = _height_map[i2].height;
 			h2 = _height_map[i2].min_height();
 			f2 = _height_map[i2].is_flat();
-			height = max(h1, h2);
+			height = std::max(h1, h2);
 		}
 		if (valid_index(i3)) {
 			t3 = _height_map[i3].height;
 			h3 = _height_map[i3].min_height();
 			f3 = _height_map[i3].is_flat();
-			height = max(height, h3);
+			height = std::max(height, h3);
 		}
 		if (valid_index(i4)) {
 			t4 = _height_map[i4].height;
 			h4 = _height_map[i4].min_height();
 			f4 = _height_map[i4].is_flat();
-			height = max(height, h4);
+			height = std::max(height, h4);
 		}
 		
 		if (valid_placement) {
@@ -486,52 +633,42 @@ bool TerrainEntityPlacement::is_valid_entity_index(int index) {
 
 /********************************************************************************************************************************************************/
 
-TerrainEntities::TerrainEntities() {
-	_entities.resize(_width * _length + ((_width - 1) * (_length - 1)));
-}
+// Entities are found through the entity manager's SpatialGrid -- the terrain keeps no index of its own
 
-void TerrainEntities::add_entity(std::shared_ptr<Entity> entity) {
-	std::cout << _entity_index << '\n';
-	_entities[_entity_index] = entity;
+TerrainEntities::TerrainEntities()
+{}
 
+// the entity manager indexes it once the server adds it
+void TerrainEntities::add_entity(std::shared_ptr<Entity> entity) {
 	const auto transform = entity->get<TransformComponent>();
-	transform->_transform.set_position(entity_placement());
-}
-
-std::shared_ptr<Entity> TerrainEntities::remove_entity() {
-	if(!_valid_entity_index) {
-		return nullptr;
-	}
-
-	const auto entity = _entities[_entity_index];
-	_entities[_entity_index] = nullptr;
-	return entity;
+	transform->set(entity_placement());
 }
 
 std::shared_ptr<Entity> TerrainEntities::get_entity() {
-	if(!_valid_entity_index) {
+	if(!_valid_index) {
 		return nullptr;
 	}
 
-	return _entities[_entity_index];
+	const glm::vec3 placement = entity_placement();
+	const auto entities = Environment::get().get_resource_manager()->query_radius(placement, 0.0f);
+
+	return entities.empty() ? nullptr : entities.front();
 }
 
+// entities touching the selected tile follow its new height
 void TerrainEntities::adjust_entity_height() {
 	if(!_valid_index) {
 		return;
 	}
 
-	for (unsigned int i = 0; i < TOTAL_POSITIONS; ++i) {
-		const int index = entity_index(_x, _z, i); 
-		if (is_valid_entity_index(index)) {
-			const auto entity = _entities[index];
-			if (entity) {
-				const auto transform = entity->get<TransformComponent>();
-				const auto position = transform->_transform.get_position();
-				float height = entity_tile_height(_index, i);
-				transform->_transform.set_position(glm::vec3(position.x, height, position.z));
-			}
-		}
+	CollisionBox tile;
+	tile.min = glm::vec3(_x * _tile_width, 0.0f, _z * _tile_length);
+	tile.max = glm::vec3((_x + 1) * _tile_width, 0.0f, (_z + 1) * _tile_length);
+
+	for (const auto& entity : Environment::get().get_resource_manager()->query_box(tile)) {
+		const auto transform = entity->get<TransformComponent>();
+		const auto position = transform->_transform.get_position();
+		transform->set(glm::vec3(position.x, exact_height(position.x, position.z), position.z));
 	}
 }
 
@@ -540,63 +677,13 @@ bool TerrainEntities::is_empty_tile() {
 		return false;
 	}
 
-	return _entities[_index] == nullptr ? true : false;
+	return get_entity() == nullptr;
 }
 
-// broke needs to use _entity_index
 std::shared_ptr<Entity> TerrainEntities::select_entity(glm::vec3 world_space, glm::vec3 position) {
-	float height = position.y;
-	const float increment = height > 1.0f ? height * 0.01f : 0.01f;
-
-	while (above_entity(world_space, position, height)) {
-		height -= increment;
-
-		if(height <= 0.0f) {
-			return nullptr;
-		}
-	}
-
-	const float y = abs((position.y - height) / world_space.y);
-	const float x = (y * world_space.x + position.x) / _tile_width;
-	const float z = (y * world_space.z + position.z) / _tile_length;
-
-	const int index = (int)z * _width + (int)x;
+	const auto entities = Environment::get().get_resource_manager()->query_ray(position, world_space, std::numeric_limits<float>::max());
 
-	std::cout << index << '\n';
-
-	return _entities[index];
-}
-
-// broke needs to use _entity_index
-bool TerrainEntities::above_entity(glm::vec3 world_space, glm::vec3 position, float height) {
-	const float y = abs((position.y - height) / world_space.y);
-	const float x = (y * world_space.x + position.x) / _tile_width;
-	const float z = (y * world_space.z + position.z) / _tile_length;
-
-	const float e_height = entity_height((int)x, (int)z);
-
-	if (height > e_height) {
-		return true;
-	}
-
-	return false;
-}
-
-// broke needs to use _entity_index
-float TerrainEntities::entity_height(int x, int z) {
-	if (x < 0 || x >= _width || z < 0 || z >= _length) {
-		return 0.0f;
-	}
-
-	const int index = z * _width + x;
-
-	if (_entities[index] != nullptr) {
-		std::cout << "max y: " << _entities[index]->get<TransformComponent>()->_transform.get_position().y << '\n';
-		const auto transform = _entities[index]->get<TransformComponent>();
-		return transform->_collision_box.max.y + transform->_transform.get_position().y;
-	}
-
-	return 0.0f;
+	return entities.empty() ? nullptr : entities.front();
 }
 
 glm::vec3 TerrainEntities::entity_placement() {
@@ -606,11 +693,12 @@ glm::vec3 TerrainEntities::entity_placement() {
 /********************************************************************************************************************************************************/
 
 Terrain::Terrain(int width, int length, float tile_width, float tile_length) :
-	TerrainData			( width, length, tile_width, tile_length )
+	TerrainData			( width, length, tile_width, tile_length ),
+	_frame				( 0 )
 {
 	generate_vertex_data();
 	generate_uv_data();
-	generate_position_data();
+	generate_chunks();
 
 	load_textures();
 
@@ -618,11 +706,12 @@ Terrain::Terrain(int width, int length, float tile_width, float tile_length) :
 }
 
 Terrain::Terrain(TerrainData&& terrain_data) noexcept :
-	TerrainData		( std::move(terrain_data) )
+	TerrainData		( std::move(terrain_data) ),
+	_frame			( 0 )
 {
 	generate_vertex_data();
 	generate_uv_data();
-	generate_position_data();
+	generate_chunks();
 
 	load_textures();
 
@@ -633,8 +722,9 @@ Terrain::~Terrain() {
 	glDeleteVertexArrays(1, &_vao);
 	glDeleteBuffers(1, &_vertex_buffer);
 	glDeleteBuffers(1, &_uv_buffer);
+	glDeleteBuffers(1, &_instance_buffer);
+	glDeleteBuffers(1, &_indirect_buffer);
 
-	glDeleteTextures(1, &_height_texture);
 	glDeleteTextures(1, &_tile_texture._id);
 }
 
@@ -642,39 +732,39 @@ void Terrain::generate_vertex_data() {
 	_vertex_data.reserve(6 * 5);
 
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f)); // height
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f));
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f));
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f));
-
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f));
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f));
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length));
-
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length));
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length));
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length));
-
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f));
+
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f));
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f));
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f));
+
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f));
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f));
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f));
+
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f)); // height
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f)); // height
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length));
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length));
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f));
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f));
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f)); // height
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f));
 
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f)); // height
 	_vertex_data.push_back(glm::vec2(0.0f, 0.0f));  // height
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, 0.0f)); // height
-	_vertex_data.push_back(glm::vec2(0.0f, _tile_length)); // height
-	_vertex_data.push_back(glm::vec2(_tile_width, _tile_length)); // height
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 0.0f)); // height
+	_vertex_data.push_back(glm::vec2(0.0f, 1.0f)); // height
+	_vertex_data.push_back(glm::vec2(1.0f, 1.0f)); // height
 }
 
 void Terrain::generate_uv_data() {
@@ -716,18 +806,174 @@ void Terrain::generate_uv_data() {
 	_uv_data.push_back(glm::vec2(1, 0.5));
 }
 
-void Terrain::generate_position_data() {
-	for (int i = 0; i < _length; ++i) {
-		for (int j = 0; j < _width; ++j) {
-			_position_data.push_back(glm::vec2(j * _tile_width, i * _tile_length));
+void Terrain::generate_chunks() {
+	for (int chunk_z = 0; chunk_z < _length; chunk_z += TERRAIN_CHUNK_TILES) {
+		for (int chunk_x = 0; chunk_x < _width; chunk_x += TERRAIN_CHUNK_TILES) {
+			TerrainChunk chunk;
+			chunk.x = chunk_x;
+			chunk.z = chunk_z;
+			chunk.width = std::min(TERRAIN_CHUNK_TILES, _width - chunk_x);
+			chunk.length = std::min(TERRAIN_CHUNK_TILES, _length - chunk_z);
+
+			_chunks.push_back(chunk);
+			_chunk_boxes.push({ glm::vec3(0.0f), glm::vec3(0.0f) });
+		}
+	}
+	_chunk_boxes.pad();
+
+	for (int i = 0; i < (int)_chunks.size(); ++i) {
+		update_chunk_box(i);
+	}
+
+	_slots.assign(TERRAIN_RESIDENT_CHUNKS, -1);
+}
+
+int Terrain::chunk_index(int index) {
+	const int chunks_x = (_width + TERRAIN_CHUNK_TILES - 1) / TERRAIN_CHUNK_TILES;
+	return (index / _width / TERRAIN_CHUNK_TILES) * chunks_x + (index % _width) / TERRAIN_CHUNK_TILES;
+}
+
+void Terrain::update_chunk_box(int chunk) {
+	const TerrainChunk& c = _chunks[chunk];
+
+	float min = 0.0f;
+	float max = 0.0f;
+	for (int i = c.z; i < c.z + c.length; ++i) {
+		for (int j = c.x; j < c.x + c.width; ++j) {
+			const TileHeight& tile = _height_map[i * _width + j];
+			for (int k = 0; k < 4; ++k) {
+				min = std::min(min, tile.height[k]);
+				max = std::max(max, tile.height[k]);
+			}
+		}
+	}
+
+	_chunk_boxes.set(chunk, {
+		glm::vec3(c.x * _tile_width, min, c.z * _tile_length),
+		glm::vec3((c.x + c.width) * _tile_width, max, (c.z + c.length) * _tile_length)
+	});
+}
+
+float Terrain::chunk_distance(int chunk, glm::vec3 eye) {
+	const glm::vec3 min(_chunk_boxes.min_x[chunk], _chunk_boxes.min_y[chunk], _chunk_boxes.min_z[chunk]);
+	const glm::vec3 max(_chunk_boxes.max_x[chunk], _chunk_boxes.max_y[chunk], _chunk_boxes.max_z[chunk]);
+	return glm::length(glm::clamp(eye, min, max) - eye);
+}
+
+int Terrain::distance_lod(float distance) {
+	int lod = 0;
+	for (float reach = TERRAIN_LOD_DISTANCE; lod < TERRAIN_MAX_LOD && distance >= reach; reach *= 2.0f) {
+		++lod;
+	}
+	return lod;
+}
+
+bool Terrain::upload_chunk(int chunk, int lod) {
+	TerrainChunk& c = _chunks[chunk];
+	if (c.slot == -1) {
+		c.slot = acquire_slot();
+		if (c.slot == -1) {
+			return false;
 		}
+		_slots[c.slot] = chunk;
+	}
+
+	_instances.clear();
+	build_blocks(c.x, c.z, c.width, c.length, 1 << lod);
+
+	glNamedBufferSubData(_instance_buffer, sizeof(TerrainInstance) * TERRAIN_CHUNK_INSTANCES * c.slot, sizeof(TerrainInstance) * _instances.size(), _instances.data());
+
+	c.lod = lod;
+	c.count = (int)_instances.size();
+	c.dirty = false;
+	return true;
+}
+
+void Terrain::upload_coarse(int chunk) {
+	TerrainChunk& c = _chunks[chunk];
+
+	_instances.clear();
+	build_blocks(c.x, c.z, c.width, c.length, 1 << TERRAIN_MAX_LOD);
+
+	glNamedBufferSubData(_instance_buffer, sizeof(TerrainInstance) * (TERRAIN_COARSE_INSTANCES + chunk), sizeof(TerrainInstance), _instances.data());
+
+	c.coarse_dirty = false;
+}
+
+// a free slot, else the one holding the chunk seen longest ago
+int Terrain::acquire_slot() {
+	int oldest = -1;
+	for (int i = 0; i < (int)_slots.size(); ++i) {
+		if (_slots[i] == -1) {
+			return i;
+		}
+
+		const unsigned int used = _chunks[_slots[i]].used;
+		if (used != _frame && (oldest == -1 || used < _chunks[_slots[oldest]].used)) {
+			oldest = i;
+		}
+	}
+
+	if (oldest != -1) {
+		_chunks[_slots[oldest]].slot = -1;
+		_chunks[_slots[oldest]].lod = -1;
+	}
+	return oldest;
+}
+
+// quadtree over the tiles -- a block is kept whole once it fits in block tiles a side or is one flat level
+// far blocks take their corner tiles' heights, the skirts down to 0 hide where they meet finer neighbours
+void Terrain::build_blocks(int x, int z, int width, int length, int block) {
+	if ((width <= block && length <= block) || is_flat_block(x, z, width, length)) {
+		const int right = x + width - 1;
+		const int bottom = z + length - 1;
+
+		TerrainInstance instance;
+		instance.position = glm::vec2(x, z);
+		instance.size = glm::vec2(width, length);
+		instance.height = glm::vec4(
+			_height_map[z * _width + x].height[0],
+			_height_map[z * _width + right].height[1],
+			_height_map[bottom * _width + x].height[2],
+			_height_map[bottom * _width + right].height[3]
+		);
+
+		_instances.push_back(instance);
+		return;
+	}
+
+	const int left = (width + 1) / 2;
+	const int top = (length + 1) / 2;
+
+	build_blocks(x, z, left, top, block);
+	if (width > left) {
+		build_blocks(x + left, z, width - left, top, block);
+	}
+	if (length > top) {
+		build_blocks(x, z + top, left, length - top, block);
+	}
+	if (width > left && length > top) {
+		build_blocks(x + left, z + top, width - left, length - top, block);
 	}
 }
 
+bool Terrain::is_flat_block(int x, int z, int width, int length) {
+	const GLfloat height = _height_map[z * _width + x].height[0];
+	for (int i = z; i < z + length; ++i) {
+		for (int j = x; j < x + width; ++j) {
+			TileHeight& tile = _height_map[i * _width + j];
+			if (!tile.is_flat() || tile.height[0] != height) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 void Terrain::load_textures() {
-	_tile_texture._id = SOIL_load_OGL_texture("Data\\Terrain\\tile.png", SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, 0);
+	_tile_texture._id = SOIL_load_OGL_texture("Data/Terrain/tile.png", SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, 0);
 	if (_tile_texture._id == 0) {
-		std::cout << "SOIL RESULT " << SOIL_last_result() << " Data\\tiles.png" << '\n';
+		std::cout << "SOIL RESULT " << SOIL_last_result() << " Data/tiles.png" << '\n';
 	}
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -862,16 +1108,24 @@ void Terrain::adjust_vertex_height(int index, int vertex, float height) {
 	}
 
 	_height_map[index].height[vertex] = height;
+	update_plane(index);
 
-	glBindBuffer(GL_ARRAY_BUFFER, _height_buffer);
-	glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 4 * index + sizeof(GLfloat) * vertex, sizeof(GLfloat), &_height_map[index].height[vertex]);
+	const int chunk = chunk_index(index);
+	_chunks[chunk].dirty = true;
+	_chunks[chunk].coarse_dirty = true;
+	update_chunk_box(chunk);
+
+	if (const auto pathfinder = Environment::get().get_resource_manager()->get_pathfinder()) {
+		pathfinder->terrain_changed(index % _width, index / _width);
+	}
 }
 
 void Terrain::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(TERRAIN_SHADER_ID)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(TERRAIN_SHADER_ID);
+	_program = program->_id;
 	glUseProgram(_program);
 
 	glCreateBuffers(1, &_vertex_buffer);
@@ -886,42 +1140,87 @@ void Terrain::create_vao() {
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
 
-	glCreateBuffers(1, &_position_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, _position_buffer);
-	glNamedBufferStorage(_position_buffer, sizeof(glm::vec2) * _position_data.size(), &_position_data[0], 0);
+	// sized for every slot up front -- chunks are written into it as they become resident
+	// then one coarse block per chunk, all written now
+	glCreateBuffers(1, &_instance_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, _instance_buffer);
+	glNamedBufferStorage(_instance_buffer, sizeof(TerrainInstance) * (TERRAIN_COARSE_INSTANCES + _chunks.size()), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	for (int i = 0; i < (int)_chunks.size(); ++i) {
+		upload_coarse(i);
+	}
 	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TerrainInstance), (void*)offsetof(TerrainInstance, position));
 	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(TerrainInstance), (void*)offsetof(TerrainInstance, size));
+	glVertexAttribDivisor(3, 1);
+	glEnableVertexAttribArray(4);
+	glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(TerrainInstance), (void*)offsetof(TerrainInstance, height));
+	glVertexAttribDivisor(4, 1);
 
-	glCreateBuffers(1, &_height_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, _height_buffer);
-	glNamedBufferStorage(_height_buffer, sizeof(GLfloat) * 4 * _height_map.size(), &_height_map[0], GL_DYNAMIC_STORAGE_BIT);
-
-	glCreateTextures(GL_TEXTURE_BUFFER, 1, &_height_texture);
-	glTextureBuffer(_height_texture, GL_R32F, _height_buffer);
+	glCreateBuffers(1, &_indirect_buffer);
 
-	glUniform1i(glGetUniformLocation(_program, "height"), 0);
-	glUniform1i(glGetUniformLocation(_program, "tile_texture"), 1);
+	glUniform2f(program->uniform("tile_size"), _tile_width, _tile_length);
+	glUniform1i(program->uniform("tile_texture"), 1);
 
 	glActiveTexture(GL_TEXTURE1);
 	glBindTexture(GL_TEXTURE_2D, _tile_texture._id);
 }
 
-void Terrain::draw(int mode, bool draw_tile) {
+// visible chunks that arent resident, or were built at another lod, are rebuilt nearest first a few a frame
+// until then a chunk keeps its old blocks, or is drawn as its coarse block if it has none
+void Terrain::draw(int mode, const Frustum& frustum, glm::vec3 eye, bool draw_tile) {
+	++_frame;
+	frustum.cull(_chunk_boxes, _visible_chunks);
+
+	_uploads.clear();
+	for (const int i : _visible_chunks) {
+		TerrainChunk& chunk = _chunks[i];
+		chunk.used = _frame;
+
+		const float distance = chunk_distance(i, eye);
+		if (chunk.slot == -1 || chunk.dirty || chunk.lod != distance_lod(distance)) {
+			_uploads.push_back({ distance, i });
+		}
+	}
+
+	std::sort(_uploads.begin(), _uploads.end());
+	const int uploads = std::min((int)_uploads.size(), TERRAIN_UPLOADS_PER_FRAME);
+	for (int i = 0; i < uploads; ++i) {
+		if (!upload_chunk(_uploads[i].second, distance_lod(_uploads[i].first))) {
+			break;
+		}
+	}
+
+	_commands.clear();
+	for (const int i : _visible_chunks) {
+		const TerrainChunk& chunk = _chunks[i];
+		if (chunk.slot != -1) {
+			_commands.push_back({ 6 * 5, (GLuint)chunk.count, 0, (GLuint)(TERRAIN_CHUNK_INSTANCES * chunk.slot) });
+			continue;
+		}
+
+		// more chunks in view than slots -- drawn rather than left as a hole
+		if (chunk.coarse_dirty) {
+			upload_coarse(i);
+		}
+		_commands.push_back({ 6 * 5, 1, 0, (GLuint)(TERRAIN_COARSE_INSTANCES + i) });
+	}
+
 	glBindVertexArray(_vao);
 	glUseProgram(_program);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_BUFFER, _height_texture);
-	glBindTextureUnit(GL_TEXTURE0, _height_buffer);
-
 	glActiveTexture(GL_TEXTURE1);
 	glBindTexture(GL_TEXTURE_2D, _tile_texture._id);
 
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 
-	glDrawArraysInstanced(mode, 0, 6 * 5, _position_data.size());
+	if (!_commands.empty()) {
+		glNamedBufferData(_indirect_buffer, sizeof(DrawArraysCommand) * _commands.size(), _commands.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+		glMultiDrawArraysIndirect(mode, 0, (GLsizei)_commands.size(), 0);
+	}
 
 	if (draw_tile) {
 		TileSelection::draw();
@@ -930,14 +1229,6 @@ void Terrain::draw(int mode, bool draw_tile) {
 	glDisable(GL_CULL_FACE);
 }
 
-float Terrain::get_tile_width() {
-	return _tile_width;
-}
-
-float Terrain::get_tile_length() {
-	return _tile_length;
-}
-
 TileHeight Terrain::get_tile_height(int x, int z) {
 	if(z < 0 || z >= _length ||
 		x < 0 || x >= _width) {
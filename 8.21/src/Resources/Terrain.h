@@ -13,6 +13,25 @@
 #include "Texture.h"
 #include "Transform.h"
 #include "../src/Entities/Entity.h"
+#include "../src/Utility/Collision.h"
+
+// tiles along each side of a chunk -- terrain is culled, streamed and given a level of detail a chunk at a time
+#define TERRAIN_CHUNK_TILES 16
+#define TERRAIN_CHUNK_INSTANCES (TERRAIN_CHUNK_TILES * TERRAIN_CHUNK_TILES)
+
+// chunks with instances on the gpu at once -- the instance buffer never grows past this however big the map
+// past it a visible chunk is drawn from its one coarse block -- every chunk has one after the slots
+#define TERRAIN_RESIDENT_CHUNKS 512
+#define TERRAIN_COARSE_INSTANCES (TERRAIN_CHUNK_INSTANCES * TERRAIN_RESIDENT_CHUNKS)
+// chunks built and uploaded per frame, nearest first
+#define TERRAIN_UPLOADS_PER_FRAME 32
+
+// full detail this close to the camera, then blocks twice as wide every time the distance doubles
+#define TERRAIN_LOD_DISTANCE 48.0f
+// 2^4 tiles -- a whole chunk as one block
+#define TERRAIN_MAX_LOD 4
+
+class Frustum;
 
 /********************************************************************************************************************************************************/
 
@@ -43,6 +62,48 @@ struct TileHeight {
 	}
 };
 
+// a square of tiles -- while resident its blocks sit in slot's part of the instance buffer
+struct TerrainChunk {
+	int x = 0;
+	int z = 0;
+	int width = 0;
+	int length = 0;
+
+	int slot = -1;
+	int lod = -1;
+	int count = 0;
+	// heights changed since its blocks were built
+	bool dirty = true;
+	// heights changed since its coarse block was built
+	bool coarse_dirty = true;
+	// last frame it was seen -- the oldest is evicted first
+	unsigned int used = 0;
+};
+
+// one drawn block of tiles -- a single tile up close, merged with its neighbours when flat or far away
+// position and size in tiles, the shader scales them
+struct TerrainInstance {
+	glm::vec2 position;
+	glm::vec2 size;
+	// the block's corners, numbered as in TileHeight
+	glm::vec4 height;
+};
+
+// laid out the way glMultiDrawArraysIndirect reads it
+struct DrawArraysCommand {
+	GLuint count;
+	GLuint instance_count;
+	GLuint first;
+	GLuint base_instance;
+};
+
+// exact_height() over one tile -- base + slope_x * fx + slope_z * fz for fx, fz how far into the tile
+struct TilePlane {
+	float base = 0.0f;
+	float slope_x = 0.0f;
+	float slope_z = 0.0f;
+};
+
 /********************************************************************************************************************************************************/
 
 class TerrainData {
@@ -53,6 +114,21 @@ public:
 
 	void save(std::ofstream& file);
 	void load(FileReader& file);
+
+	float exact_height(float x, float z);
+	// exact_height() for count positions at once -- y can't alias x or z
+	void exact_heights(const float* x, const float* z, float* y, int count);
+
+	// flat or a ramp rising along one axis, with every edge meeting its neighbours -- false off the map
+	bool is_walkable(int x, int z);
+
+	// longest side in world units
+	float get_world_size();
+
+	int get_width();
+	int get_length();
+	float get_tile_width();
+	float get_tile_length();
 protected:
 	int _width;
 	int _length;
@@ -60,6 +136,12 @@ protected:
 	float _tile_length;
 
 	std::vector<TileHeight> _height_map;
+
+	// one per tile -- update_plane() whenever its TileHeight changes
+	std::vector<TilePlane> _planes;
+
+	void update_plane(int index);
+	void update_planes();
 };
 
 /********************************************************************************************************************************************************/
@@ -86,8 +168,8 @@ public:
 
 	bool is_valid_tile();
 
-	bool above_terrain(glm::vec3 world_space, glm::vec3 position, float height);
-	float exact_height(float x, float z);
+	// first height down the ray from position that isnt above the terrain
+	float ray_height(glm::vec3 world_space, glm::vec3 position);
 
 	glm::vec2 get_selected_tile();
 protected:
@@ -109,6 +191,12 @@ private:
 	GLuint _program;
 	GLuint _vertex_buffer;
 
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint model = -1;
+		GLint color = -1;
+	} _uniforms;
+
 	glm::vec4 _color;
 
 	Transform _transform;
@@ -146,18 +234,15 @@ public:
 	TerrainEntities();
 
 	void add_entity(std::shared_ptr<Entity> entity);
-	std::shared_ptr<Entity> remove_entity();
+	// entity at the selected placement
 	std::shared_ptr<Entity> get_entity();
 	void adjust_entity_height();
 
+	// nearest entity along world_space from position
 	std::shared_ptr<Entity> select_entity(glm::vec3 world_space, glm::vec3 position);
-	bool above_entity(glm::vec3 world_space, glm::vec3 position, float height);
-	float entity_height(int x, int z);
 	glm::vec3 entity_placement();
 
 	bool is_empty_tile();
-protected:
-	std::vector<std::shared_ptr<Entity>> _entities;
 };
 
 /********************************************************************************************************************************************************/
@@ -168,7 +253,8 @@ public:
 	Terrain(TerrainData&& terrain_data) noexcept;
 	~Terrain();
 
-	void draw(int mode, bool draw_tile = true);
+	// only the chunks inside frustum, in less detail the further they are from eye
+	void draw(int mode, const Frustum& frustum, glm::vec3 eye, bool draw_tile = true);
 	void adjust_tile_height(float height);
 	void adjust_ramp_height();
 	void adjust_front_ramp();
@@ -178,28 +264,53 @@ public:
 
 	void adjust_vertex_height(int index, int vertex, float height);
 
-	float get_tile_width();
-	float get_tile_length();
 	TileHeight get_tile_height(int x, int z);
 	float get_vertex_height(int index, int vertex);
 private:
 	void generate_vertex_data();
 	void generate_uv_data();
-	void generate_position_data();
+	void generate_chunks();
 	void load_textures();
 	void create_vao();
+
+	int chunk_index(int index);
+	void update_chunk_box(int chunk);
+	// to the nearest point of its box
+	float chunk_distance(int chunk, glm::vec3 eye);
+	int distance_lod(float distance);
+
+	// builds chunk's blocks at lod into its slot -- false with every slot taken by a chunk seen this frame
+	bool upload_chunk(int chunk, int lod);
+	// the whole chunk as one block at TERRAIN_COARSE_INSTANCES + chunk
+	void upload_coarse(int chunk);
+	int acquire_slot();
+	void build_blocks(int x, int z, int width, int length, int block);
+	bool is_flat_block(int x, int z, int width, int length);
 private:
 	std::vector<glm::vec2> _vertex_data;
 	std::vector<glm::vec2> _uv_data;
-	std::vector<glm::vec2> _position_data;
+
+	std::vector<TerrainChunk> _chunks;
+	// one box per chunk in the same order -- y from the lowest of its heights and the skirts at 0 up to its highest
+	CollisionBatch _chunk_boxes;
+
+	// chunk in each slot, -1 when free
+	std::vector<int> _slots;
+	unsigned int _frame;
+
+	// reused every draw()
+	std::vector<int> _visible_chunks;
+	std::vector<std::pair<float, int>> _uploads;
+	std::vector<TerrainInstance> _instances;
+	std::vector<DrawArraysCommand> _commands;
 
 	GLuint _vao;
 	GLuint _program;
 	GLuint _vertex_buffer;
 	GLuint _uv_buffer;
-	GLuint _position_buffer;
-	GLuint _height_buffer;
-	GLuint _height_texture;
+	// TERRAIN_CHUNK_INSTANCES per slot
+	GLuint _instance_buffer;
+	GLuint _indirect_buffer;
 
 	Texture _tile_texture;
 };
@@ -5,10 +5,11 @@ Transform::Transform(
 	_position			( position ),
 	_scale				( scale ),
 	_rotation			( rotation ),
-	_rotation_matrix	( glm::mat4(1) )
-{
-	setup_matrices();
-}
+	_rotation_matrix	( glm::mat4(1) ),
+	_position_dirty		( true ),
+	_scale_dirty		( true ),
+	_rotation_dirty		( true )
+{}
 
 Transform::Transform(const Transform& rhs) :
 	_position			( rhs._position ),
@@ -20,45 +21,55 @@ Transform::Transform(const Transform& rhs) :
 	_rotation_matrix_y  ( rhs._rotation_matrix_y ),
 	_rotation_matrix_z  ( rhs._rotation_matrix_z ),
 	_rotation_matrix	( rhs._rotation_matrix ),
-	_model				( rhs._model )
+	_model				( rhs._model ),
+	_position_dirty		( rhs._position_dirty ),
+	_scale_dirty		( rhs._scale_dirty ),
+	_rotation_dirty		( rhs._rotation_dirty )
 {}
 
 void Transform::setup_matrices() {
-	_position_matrix = glm::translate(glm::mat4(1.0f), _position);
-	_scale_matrix = glm::scale(glm::mat4(1.0f), _scale);
-	_rotation_matrix_x = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.x), glm::vec3(1, 0, 0));
-	_rotation_matrix_y = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.y), glm::vec3(0, 1, 0));
-	_rotation_matrix_z = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.z), glm::vec3(0, 0, 1));
+	if (_position_dirty) {
+		_position_matrix = glm::translate(glm::mat4(1.0f), _position);
+	}
+
+	if (_scale_dirty) {
+		_scale_matrix = glm::scale(glm::mat4(1.0f), _scale);
+	}
+
+	if (_rotation_dirty) {
+		_rotation_matrix_x = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.x), glm::vec3(1, 0, 0));
+		_rotation_matrix_y = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.y), glm::vec3(0, 1, 0));
+		_rotation_matrix_z = glm::rotate(glm::mat4(1.0f), glm::radians(_rotation.z), glm::vec3(0, 0, 1));
+		_rotation_matrix = _rotation_matrix_x * _rotation_matrix_y * _rotation_matrix_z;
+	}
 
-	_rotation_matrix = _rotation_matrix_x * _rotation_matrix_y * _rotation_matrix_z;
 	_model = _position_matrix * _rotation_matrix * _scale_matrix;
+
+	_position_dirty = false;
+	_scale_dirty = false;
+	_rotation_dirty = false;
 }
 
 void Transform::set_position(const glm::vec3 posiiton) {
 	_position = posiiton;
-	_position_matrix = glm::translate(glm::mat4(1.0f), _position);
-
-	_model = _position_matrix * _rotation_matrix * _scale_matrix;
+	_position_dirty = true;
 }
 
 void Transform::set_scale(const glm::vec3 scale) {
 	_scale = scale;
-	_scale_matrix = glm::scale(glm::mat4(1.0f), _scale);
-
-	_model = _position_matrix * _rotation_matrix * _scale_matrix;
+	_scale_dirty = true;
 }
 
 void Transform::set_rotation(const glm::vec3 rotation) {
 	_rotation = rotation;
-	_rotation_matrix_x = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.x), glm::vec3(1, 0, 0));
-	_rotation_matrix_y = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.y), glm::vec3(0, 1, 0));
-	_rotation_matrix_z = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.z), glm::vec3(0, 0, 1));
-
-	_rotation_matrix = _rotation_matrix_x * _rotation_matrix_y * _rotation_matrix_z;
-	_model = _position_matrix * _rotation_matrix * _scale_matrix;
+	_rotation_dirty = true;
 }
 
 glm::mat4 Transform::get_model() {
+	if (_position_dirty || _scale_dirty || _rotation_dirty) {
+		setup_matrices();
+	}
+
 	return _model;
 }
 
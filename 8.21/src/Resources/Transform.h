@@ -13,6 +13,7 @@ public:
 
 	Transform(const Transform& rhs);
 
+	// rebuilds whatever changed since the last get_model()
 	void setup_matrices();
 
 	void set_position(const glm::vec3 posiiton);
@@ -36,6 +37,11 @@ private:
 	glm::vec3 _position;
 	glm::vec3 _scale;
 	glm::vec3 _rotation;
+
+	// setters only mark the matrices -- nothing is built until get_model()
+	bool _position_dirty;
+	bool _scale_dirty;
+	bool _rotation_dirty;
 };
 
 #endif
\ No newline at end of file
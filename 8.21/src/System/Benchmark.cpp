@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "../src/Utility/Clock.h"
+#include "../src/Utility/JobSystem.h"
+#include "../src/System/ResourceManager.h"
+#include "../src/Resources/Terrain.h"
+#include "../src/Entities/Entity.h"
+#include "../src/Entities/Components/TransformComponent.h"
+
+#include "../src/Network/Fmtout.h"
+
+#define BENCHMARK_ENTITIES 100000
+#define BENCHMARK_WARMUP_TICKS 5
+#define BENCHMARK_TICKS 50
+#define BENCHMARK_TICK_RATE 20
+
+Benchmark::Benchmark() {
+	_environment.set_mode(MODE_SERVER);
+
+	Clock* clock = new Clock;
+	clock->set_step(1.0 / BENCHMARK_TICK_RATE);
+	_environment.set_clock(clock);
+
+	ResourceManager* resource_manager = new ResourceManager;
+	_environment.set_resource_manager(resource_manager);
+	resource_manager->load_resources(0, 0, 0, 0, 1);
+
+	_entities.reserve(BENCHMARK_ENTITIES);
+	for (int i = 0; i < BENCHMARK_ENTITIES; ++i) {
+		auto entity = std::make_shared<Entity>();
+		entity->add<TransformComponent>();
+		_entities.push_back(entity);
+	}
+}
+
+Benchmark::~Benchmark() {
+	_entities.clear();
+}
+
+void Benchmark::run() {
+	const int max_threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+	fmtout("Benchmark", BENCHMARK_ENTITIES, "entities", BENCHMARK_TICKS, "ticks", max_threads, "hardware threads");
+
+	double single = 0.0;
+	for (int threads = 1; ; threads *= 2) {
+		threads = std::min(threads, max_threads);
+
+		// 1 thread runs the serial path -- no job system at all
+		delete _environment.get_job_system();
+		_environment.set_job_system(threads > 1 ? new JobSystem(threads - 1) : nullptr);
+
+		reset();
+		time_ticks(BENCHMARK_WARMUP_TICKS);
+		reset();
+		const double ms = time_ticks(BENCHMARK_TICKS);
+
+		if (threads == 1) {
+			single = ms;
+		}
+		fmtout(threads, "threads", ms, "ms/tick", "speedup", single / ms);
+
+		if (threads == max_threads) {
+			break;
+		}
+	}
+}
+
+// spread over the map walking to the mirrored point -- far enough not to arrive during the run
+void Benchmark::reset() {
+	const auto terrain = _environment.get_resource_manager()->get_terrain_data();
+	const float width = terrain ? (float)terrain->get_width() : 256.0f;
+	const float length = terrain ? (float)terrain->get_length() : 256.0f;
+
+	for (int i = 0; i < (int)_entities.size(); ++i) {
+		const float x = (float)((i * 7919) % 1000) / 1000.0f * width;
+		const float z = (float)((i * 104729) % 1000) / 1000.0f * length;
+
+		auto transform = _entities[i]->get<TransformComponent>();
+		transform->set(glm::vec3(x, 0.0f, z));
+		transform->_destination = glm::vec3(width - x, 0.0f, length - z);
+		transform->_speed = 1.0f + (float)(i % 4);
+		transform->_dest_reached = false;
+	}
+}
+
+double Benchmark::time_ticks(int ticks) {
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ticks; ++i) {
+		TransformComponent::update_all();
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() / ticks;
+}
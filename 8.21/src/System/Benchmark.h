@@ -0,0 +1,30 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+#include <memory>
+
+#include "Environment.h"
+
+class Entity;
+
+// Headless -- times TransformComponent::update_all() with 1, 2, 4 ... hardware threads
+class Benchmark {
+public:
+	Benchmark();
+	~Benchmark();
+
+	void run();
+private:
+	// moves every entity back to where it started so each thread count does the same work
+	void reset();
+
+	// ms per tick
+	double time_ticks(int ticks);
+
+	std::vector<std::shared_ptr<Entity>> _entities;
+
+	Environment _environment;
+};
+
+#endif
@@ -47,6 +47,7 @@ Engine::Engine() :
 		// wait
 	}
 
+	client->s_set_view();
 	client->s_load_world_server();
 }
 
@@ -63,10 +64,14 @@ void Engine::run() {
 		_environment.get_clock()->update();
 		_environment.get_window()->update();
 
+		_environment.get_client()->c_interpolate();
+
 		render();
 
 		_environment.get_input_manager()->update(&_exit);
 		_environment.get_resource_manager()->update();
+
+		_environment.get_client()->s_set_view();
 	}
 	
 }
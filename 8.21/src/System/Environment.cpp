@@ -8,6 +8,7 @@
 #include "../src/System/GUIManager.h"
 #include "../src/System/Renderer.h"
 #include "../src/Network/Client.h"
+#include "../src/Utility/JobSystem.h"
 
 #include <cassert>
 
@@ -22,7 +23,8 @@ Environment::Environment() :
 	_input_manager		( nullptr ),
 	_gui_manager		( nullptr ),
 	_renderer			( nullptr ),
-	_client				( nullptr )
+	_client				( nullptr ),
+	_job_system			( nullptr )
 {
 	assert(!_instance);
 	_instance = this;
@@ -74,6 +76,10 @@ void Environment::set_client(Client* client) {
 	_client = client;
 }
 
+void Environment::set_job_system(JobSystem* job_system) {
+	_job_system = job_system;
+}
+
 int Environment::get_mode() {
 	return _mode;
 }
@@ -110,6 +116,10 @@ Client* Environment::get_client() {
 	return _client;
 }
 
+JobSystem* Environment::get_job_system() {
+	return _job_system;
+}
+
 void Environment::shut_down() {
 	if (_window) {
 		delete _window;
@@ -150,4 +160,9 @@ void Environment::shut_down() {
 		delete _client;
 		_client = nullptr;
 	}
+
+	if(_job_system) {
+		delete _job_system;
+		_job_system = nullptr;
+	}
 }
\ No newline at end of file
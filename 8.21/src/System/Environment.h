@@ -13,6 +13,7 @@ class InputManager;
 class GUIManager;
 class Renderer;
 class Client;
+class JobSystem;
 
 class Environment {
 public:
@@ -28,6 +29,7 @@ public:
 	void set_gui_manager(GUIManager* gui_manager);
 	void set_renderer(Renderer* renderer);
 	void set_client(Client* client);
+	void set_job_system(JobSystem* job_system);
 
 	int     get_mode();
 	Clock*  get_clock();
@@ -38,6 +40,7 @@ public:
 	GUIManager* get_gui_manager();
 	Renderer* get_renderer();
 	Client* get_client();
+	JobSystem* get_job_system();
 
 	void shut_down();
 
@@ -52,6 +55,7 @@ private:
 	GUIManager* _gui_manager;
 	Renderer* _renderer;
 	Client* _client;
+	JobSystem* _job_system;
 
 	static Environment* _instance;
 };
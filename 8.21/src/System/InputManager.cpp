@@ -18,37 +18,20 @@
 #include <GLFW/glfw3.h>
 
 #include <cmath>
+#include <algorithm>
 
 /********************************************************************************************************************************************************/
 
 constexpr float SCROLL_SPEED = 50000.0f;
 
 #include <iostream>
+// nearest entity under the mouse
 std::shared_ptr<Entity> select_entity(float xpos, float ypos) {
 	const auto terrain = Environment::get().get_resource_manager()->get_terrain();
 	const auto world_space = Environment::get().get_input_manager()->mouse_world_space_vector(glm::vec2(xpos, ypos));
 	const auto camera = Environment::get().get_window()->get_camera();
 
-	const auto pos = terrain->get_select_position(world_space, camera->get_position());
-	CollisionBox rect;
-	rect.min = glm::vec3(pos.x - 1, pos.y - 1, pos.z - 1);
-	rect.max = glm::vec3(pos.x + 1, pos.y + 1, pos.z + 1);
-
-	const auto entities = Environment::get().get_resource_manager()->get_entities();
-
-	std::cout << "select_entity" << '\n';
-	std::cout << pos.x << " " << pos.y << " " << pos.z << '\n';
-	for(const auto& e : *entities) {
-		if(const auto& transform = e.second->get<TransformComponent>()) {
-			if(xz_collision(rect, transform->get_collision_box())) {
-				std::cout << e.second->get_name() << '\n';
-				return e.second;
-			}
-		}
-	}
-	std::cout << "none" << '\n';
-
-	return nullptr;
+	return terrain->select_entity(world_space, camera->get_position());
 }
 
 void select_tile() {
@@ -509,19 +492,12 @@ void EntitySelection::select_all(glm::vec2 first, glm::vec2 last) {
 	Environment::get().get_renderer()->debug_add_rect(r3);
 	Environment::get().get_renderer()->debug_add_rect(r4);
 
+	// the drag can go either way
 	CollisionBox selection_rect;
-	selection_rect.min = glm::vec3(tl.x, 0, tl.z);
-	selection_rect.max = glm::vec3(br.x, 0, br.z);
-
-	const auto entities = Environment::get().get_resource_manager()->get_entities();
-	_entities.clear();
-	for(const auto& e : *entities) {
-		if(const auto& transform = e.second->get<TransformComponent>()) {
-			if(xz_collision(selection_rect, transform->get_collision_box())) {
-				_entities.push_back(e.second);
-			}
-		}
-	}
+	selection_rect.min = glm::vec3(std::min(tl.x, br.x), 0, std::min(tl.z, br.z));
+	selection_rect.max = glm::vec3(std::max(tl.x, br.x), 0, std::max(tl.z, br.z));
+
+	_entities = Environment::get().get_resource_manager()->query_box(selection_rect);
 
 	std::cout << _entities.size() << '\n';
 }
@@ -532,17 +508,16 @@ void EntitySelection::move_all(double xpos, double ypos) {
 	const auto camera = Environment::get().get_window()->get_camera();
 	const auto dest = terrain->get_select_position(world_space, camera->get_position());
 
+	// the server moves them as a group
+	std::vector<SlotId> ids;
+	ids.reserve(_entities.size());
 	for(auto& e : _entities) {
-		if(const auto& transform = e->get<TransformComponent>()) {
-			glm::vec3 dest(dest.x, 0, dest.z);
-			//transform->set_destination(dest);
-
-			auto client = Environment::get().get_client();
-			PacketData data("set_destination", client->get_id(), e->get_unique_id(), dest);
-			int len = data.length();
-			client->c_send(data.c_str(), &len);
+		if(e->get<TransformComponent>()) {
+			ids.push_back(e->get_unique_id());
 		}
 	}
+
+	Environment::get().get_client()->s_group_move(ids, glm::vec3(dest.x, 0, dest.z));
 }
 
 /********************************************************************************************************************************************************/
\ No newline at end of file
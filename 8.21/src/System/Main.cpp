@@ -1,8 +1,8 @@
-#include <conio.h>
 #include <iostream>
 
 #include "Engine.h"
 #include "Editor.h"
+#include "Benchmark.h"
 #include "../Network/Server.h"
 
 #include <thread>
@@ -25,16 +25,24 @@ void start_server() {
 	server.s_startup();
 
 
-	auto thread = std::thread(&Server::s_accept, &server);
+	auto thread = std::thread(&Server::s_listen, &server);
 
-	while(1) {
+	server.run();
 
-	}
+	server.s_decline();
+	thread.join();
+}
+
+void start_benchmark() {
+	std::cout << "Benchmark" << '\n';
+	Benchmark benchmark;
+	benchmark.run();
 }
 
-int main() {
+// the mode comes from the first argument ("2" runs the server) or else a line on stdin
+int main(int argc, char* argv[]) {
 
-	int input = _getch();
+	int input = argc > 1 ? argv[1][0] : std::cin.get();
 
 	if(input == 49) {
 		start_editor();
@@ -42,6 +50,9 @@ int main() {
 	else if(input == 50) {
 		start_server();
 	}
+	else if(input == 51) {
+		start_benchmark();
+	}
 	else {
 		start_engine();
 	}
@@ -70,7 +70,14 @@ void RendererRectangle::create_vao() {
 	glCreateVertexArrays(1, &_vao);
 	glBindVertexArray(_vao);
 
-	_program = Environment::get().get_resource_manager()->get_program(8)->_id;
+	const auto program = Environment::get().get_resource_manager()->get_program(8);
+	_program = program->_id;
+	_uniforms.width = program->uniform("width");
+	_uniforms.height = program->uniform("height");
+	_uniforms.length = program->uniform("length");
+	_uniforms.position = program->uniform("position");
+	_uniforms.color = program->uniform("color");
+
 	glUseProgram(_program);
 
 	glCreateBuffers(1, &_vertex_buffer);
@@ -84,11 +91,11 @@ void RendererRectangle::draw_rect(RectDesc rect) {
 	glBindVertexArray(_vao);
 	glUseProgram(_program);
 
-	glUniform1f(glGetUniformLocation(_program, "width"), rect.width);
-	glUniform1f(glGetUniformLocation(_program, "height"), rect.height);
-	glUniform1f(glGetUniformLocation(_program, "length"), rect.length);
-	glUniform3fv(glGetUniformLocation(_program, "position"), 1, &rect.position[0]);
-	glUniform4fv(glGetUniformLocation(_program, "color"), 1, &rect.color[0]);
+	glUniform1f(_uniforms.width, rect.width);
+	glUniform1f(_uniforms.height, rect.height);
+	glUniform1f(_uniforms.length, rect.length);
+	glUniform3fv(_uniforms.position, 1, &rect.position[0]);
+	glUniform4fv(_uniforms.color, 1, &rect.color[0]);
 	
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
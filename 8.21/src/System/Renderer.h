@@ -25,6 +25,15 @@ private:
 	GLuint _vao;
 	GLuint _vertex_buffer;
 	GLuint _program;
+
+	// looked up once in create_vao()
+	struct Uniforms {
+		GLint width = -1;
+		GLint height = -1;
+		GLint length = -1;
+		GLint position = -1;
+		GLint color = -1;
+	} _uniforms;
 };
 
 /********************************************************************************************************************************************************/
@@ -5,12 +5,14 @@
 #include "../src/Resources/Model.h"
 
 #include "../src/System/Environment.h"
+#include "../src/Utility/Clock.h"
 #include "../src/Resources/Window.h"
 #include "../src/Resources/Camera.h"
 
 #include "../src/Network/Client.h"
 
 #include "../src/Resources/Terrain.h"
+#include "../src/Utility/Pathfinder.h"
 #include "../src/Entities/Entity.h"
 
 #include "../src/Resources/Icon.h"
@@ -18,11 +20,12 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <algorithm>
 
-#define SHADER_FILE "Data\\Shaders\\shaders.txt"
-#define MODEL_FILE "Data\\Models\\models.txt"
-#define ENTITY_FILE "Data\\Entities\\entities.txt"
-#define TEXTURE_FILE "Data\\Textures\\textures.txt"
+#define SHADER_FILE "Data/Shaders/shaders.txt"
+#define MODEL_FILE "Data/Models/models.txt"
+#define ENTITY_FILE "Data/Entities/entities.txt"
+#define TEXTURE_FILE "Data/Textures/textures.txt"
 
 /********************************************************************************************************************************************************/
 
@@ -57,8 +60,6 @@ bool ProgramManager::load_program(int key, std::string_view file_path) {
 	const auto program = std::make_shared<Program>(key, file_path.data());
 	_programs[key] = program;
 
-	Environment::get().get_window()->get_camera()->attach_shader(program->_id);
-
 	return true;
 }
 
@@ -145,19 +146,39 @@ MapManager::~MapManager()
 void MapManager::load_map() {
 	//_terrain = std::make_shared<Terrain>(100, 100, 1.0f, 1.0f);
 
-	FileReader file("Data\\Map\\map.txt");
+	FileReader file("Data/Map/map.txt");
 	TerrainData terrain_data;
 	terrain_data.load(file);
-	_terrain = std::make_shared<Terrain>(std::move(terrain_data));
+
+	// server has no gl context -- height map only
+	if (Environment::get().get_mode() == MODE_SERVER) {
+		_terrain_data = std::make_shared<TerrainData>(std::move(terrain_data));
+	}
+	else {
+		_terrain = std::make_shared<Terrain>(std::move(terrain_data));
+		_terrain_data = _terrain;
+	}
+
+	_pathfinder = std::make_shared<Pathfinder>();
+	_pathfinder->build(_terrain_data.get());
 }
 
 std::shared_ptr<Terrain> MapManager::get_terrain() {
 	return _terrain;
 }
 
+std::shared_ptr<TerrainData> MapManager::get_terrain_data() {
+	return _terrain_data;
+}
+
+std::shared_ptr<Pathfinder> MapManager::get_pathfinder() {
+	return _pathfinder;
+}
+
 /********************************************************************************************************************************************************/
 
-ModelManager::ModelManager()
+ModelManager::ModelManager() :
+	_mesh_buffer		( std::make_unique<MeshBuffer>() )
 {}
 
 ModelManager::~ModelManager()
@@ -200,6 +221,65 @@ std::shared_ptr<Model> ModelManager::get_model(int key) {
 	return _models.at(key);
 }
 
+MeshBuffer* ModelManager::get_mesh_buffer() {
+	return _mesh_buffer.get();
+}
+
+// commands are sorted so meshes with the same program and textures sit together -- each run is one multi draw
+void ModelManager::draw_models() {
+	_instance_data.clear();
+	_draws.clear();
+
+	for (auto& [id, model] : _models) {
+		auto& instances = model->get_instances();
+		if (instances.empty()) {
+			continue;
+		}
+
+		const GLuint base_instance = (GLuint)_instance_data.size();
+		_instance_data.insert(_instance_data.end(), instances.begin(), instances.end());
+
+		for (auto& mesh : model->get_meshes()) {
+			_draws.push_back({ model->get_program()->_id, &mesh, mesh.command((GLuint)instances.size(), base_instance) });
+		}
+
+		instances.clear();
+	}
+
+	if (_draws.empty()) {
+		return;
+	}
+
+	std::sort(_draws.begin(), _draws.end(), [](const ModelDraw& a, const ModelDraw& b) {
+		if (a.program != b.program) {
+			return a.program < b.program;
+		}
+		return a.mesh->textures_less(*b.mesh);
+	});
+
+	_commands.clear();
+	for (const auto& draw : _draws) {
+		_commands.push_back(draw.command);
+	}
+
+	_mesh_buffer->bind();
+	_mesh_buffer->set_instances(_instance_data);
+	_mesh_buffer->set_commands(_commands);
+
+	for (size_t first = 0; first < _draws.size();) {
+		size_t last = first + 1;
+		while (last < _draws.size() && _draws[last].program == _draws[first].program && _draws[last].mesh->same_textures(*_draws[first].mesh)) {
+			++last;
+		}
+
+		glUseProgram(_draws[first].program);
+		_draws[first].mesh->bind_textures();
+		_mesh_buffer->multi_draw((int)first, (int)(last - first));
+
+		first = last;
+	}
+}
+
 /********************************************************************************************************************************************************/
 
 EntityManager::EntityManager()
@@ -232,17 +312,22 @@ void EntityManager::load_default_entities() {
 
 }
 
+// components are updated by type straight from their pools
 void EntityManager::update() {
-	auto it = _entities.begin();
-	while (it != _entities.end()) {
-		if ((it->second)->get_destroy()) {
-			it = _entities.erase(it);
-			continue;
-		}
+	std::lock_guard<std::mutex> lock(_em_mutex);
 
-		(it->second)->update();
-		++it;
+	// erasing swaps the last entity into the hole -- walk backwards
+	const auto& ids = _entities.ids();
+	for (int i = _entities.size() - 1; i >= 0; --i) {
+		if (_entities.values()[i]->get_destroy()) {
+			_spatial_grid.remove(ids[i]);
+			_entities.erase(ids[i]);
+		}
 	}
+
+	TransformComponent::update_all();
+
+	update_spatial_grid();
 }
 
 void EntityManager::save_entities(std::string_view folder) {
@@ -251,25 +336,42 @@ void EntityManager::save_entities(std::string_view folder) {
 
 	for(const auto& e : _entities) {
 		std::ofstream file;
-		file.open(folder.data() + std::to_string(e.second->get_unique_id()) + ".txt", std::ios::in | std::ios::trunc);
-		e.second->save(file);
+		file.open(folder.data() + std::to_string(e->get_unique_id()) + ".txt", std::ios::in | std::ios::trunc);
+		e->save(file);
 	}
 }
 
 void EntityManager::load_entities() {
-	for(auto& p : std::filesystem::directory_iterator("Data\\Map\\Entities")) {
+	for(auto& p : std::filesystem::directory_iterator("Data/Map/Entities")) {
 		auto entity = std::make_shared<Entity>();
 		entity->load(p.path().string());
-		_entities.insert({ entity->get_unique_id(), entity });
+		entity->set_unique_id(_entities.insert(entity));
+		index_entity(entity->get_unique_id(), entity);
 	}
 }
 
+// keeps the server's id if it has one
 void EntityManager::add_entity(std::shared_ptr<Entity> entity) {
 	std::lock_guard<std::mutex> lock(_em_mutex);
-	if(_entities.count(entity->get_unique_id())) {
+	if(entity->get_unique_id() == INVALID_ENTITY_ID) {
+		entity->set_unique_id(_entities.insert(entity));
+	}
+	else if(!_entities.insert_at(entity->get_unique_id(), entity)) {
 		assert(NULL);
 	}
-	_entities.insert({ entity->get_unique_id(), entity });
+	index_entity(entity->get_unique_id(), entity);
+}
+
+// one lock for the whole batch
+void EntityManager::add_entities(const std::vector<std::shared_ptr<Entity>>& entities) {
+	std::lock_guard<std::mutex> lock(_em_mutex);
+	_entities.reserve(_entities.size() + entities.size());
+	for(const auto& entity : entities) {
+		if(!_entities.insert_at(entity->get_unique_id(), entity)) {
+			assert(NULL);
+		}
+		index_entity(entity->get_unique_id(), entity);
+	}
 }
 
 std::shared_ptr<Entity> EntityManager::new_entity(std::string_view type, int id) {
@@ -287,11 +389,16 @@ std::shared_ptr<Entity> EntityManager::new_entity(std::string_view type, int id)
 
 void EntityManager::remove_entity(std::shared_ptr<Entity> entity) {
 	std::lock_guard<std::mutex> lock(_em_mutex);
-	for(auto it = _entities.begin(); it != _entities.end(); ++it) {
-		if((it->second) == entity) {
-			_entities.erase(it);
-			return;
-		}
+	_spatial_grid.remove(entity->get_unique_id());
+	_entities.erase(entity->get_unique_id());
+}
+
+// one lock for the whole batch
+void EntityManager::remove_entities(const std::vector<SlotId>& ids) {
+	std::lock_guard<std::mutex> lock(_em_mutex);
+	for(const auto id : ids) {
+		_spatial_grid.remove(id);
+		_entities.erase(id);
 	}
 }
 
@@ -300,10 +407,61 @@ std::shared_ptr<Entity> EntityManager::get_default_entity(std::string_view type,
 	return _default_entities.at(type.data()).at(id);
 }
 
-std::unordered_map<int, std::shared_ptr<Entity>>* EntityManager::get_entities() {
+SlotMap<std::shared_ptr<Entity>>* EntityManager::get_entities() {
 	return &_entities;
 }
 
+std::vector<std::shared_ptr<Entity>> EntityManager::query_box(const CollisionBox& box) {
+	std::lock_guard<std::mutex> lock(_em_mutex);
+	_spatial_grid.query_box(box, _query_ids);
+	return resolve_query();
+}
+
+std::vector<std::shared_ptr<Entity>> EntityManager::query_radius(glm::vec3 center, float radius) {
+	std::lock_guard<std::mutex> lock(_em_mutex);
+	_spatial_grid.query_radius(center, radius, _query_ids);
+	return resolve_query();
+}
+
+std::vector<std::shared_ptr<Entity>> EntityManager::query_ray(glm::vec3 origin, glm::vec3 dir, float max_distance) {
+	std::lock_guard<std::mutex> lock(_em_mutex);
+	_spatial_grid.query_ray(origin, dir, max_distance, _query_ids);
+	return resolve_query();
+}
+
+void EntityManager::index_entity(SlotId id, const std::shared_ptr<Entity>& entity) {
+	if (const auto transform = entity->get<TransformComponent>()) {
+		_spatial_grid.update(id, transform->get_collision_box());
+		transform->_moved = false;
+	}
+}
+
+// only transforms that moved since the last pass -- most of them stay in the same cells
+void EntityManager::update_spatial_grid() {
+	const auto& ids = _entities.ids();
+	auto& entities = _entities.values();
+	for (int i = 0; i < _entities.size(); ++i) {
+		const auto transform = entities[i]->get<TransformComponent>();
+		if (transform && transform->_moved) {
+			_spatial_grid.update(ids[i], transform->get_collision_box());
+			transform->_moved = false;
+		}
+	}
+}
+
+std::vector<std::shared_ptr<Entity>> EntityManager::resolve_query() {
+	std::vector<std::shared_ptr<Entity>> entities;
+	entities.reserve(_query_ids.size());
+	for (const auto id : _query_ids) {
+		if (const auto entity = _entities.get(id)) {
+			entities.push_back(*entity);
+		}
+	}
+
+	_query_ids.clear();
+	return entities;
+}
+
 /********************************************************************************************************************************************************/
 
 ResourceManager::ResourceManager()
@@ -318,40 +476,70 @@ void ResourceManager::load_resources(bool programs, bool textures, bool models,
 	if(models)		load_models();
 	if(entities)	load_default_entities();
 	if(map)			load_map();
+
+	_spatial_grid.resize(_terrain_data.get());
 	if (Environment::get().get_mode() == MODE_EDITOR) {
 		load_entities();
 	}
 }
 
+// entities update at the clock's fixed step however fast frames are
 void ResourceManager::update() {
-	EntityManager::update();
+	const int steps = Environment::get().get_clock()->steps();
+	for(int i = 0; i < steps; ++i) {
+		EntityManager::update();
+	}
 }
 
+// nothing outside the camera's view is drawn -- terrain by chunk, entities by their draw box
 void ResourceManager::draw() {
 	const auto mode = Environment::get().get_mode();
-	_terrain->draw(GL_TRIANGLES, mode == MODE_EDITOR);
-
-	std::lock_guard<std::mutex> lock(_em_mutex);
-	for(const auto entity : _entities) {
-		if (const auto transform = entity.second->get<TransformComponent>()) {
-			_models.at(entity.second->get_model_id())->draw(transform->_transform);
+	const auto camera = Environment::get().get_window()->get_camera();
+	_frustum.update(camera->get_projection() * camera->get_view());
+
+	_terrain->draw(GL_TRIANGLES, _frustum, camera->get_position(), mode == MODE_EDITOR);
+
+	// instanced models are only gathered here -- drawn below once the entities are unlocked
+	_em_mutex.lock();
+	_draw_boxes.clear();
+	_draw_transforms.clear();
+	for(const auto& entity : _entities) {
+		if (const auto transform = entity->get<TransformComponent>()) {
+			_draw_boxes.push(transform->get_draw_box());
+			_draw_transforms.push_back(transform);
 		}
 	}
+	_draw_boxes.pad();
+
+	_frustum.cull(_draw_boxes, _visible);
+	for (const int i : _visible) {
+		TransformComponent* transform = _draw_transforms[i];
+		const auto& model = _models.at(transform->_entity->get_model_id());
+		if (model->is_instanced()) {
+			model->add_instance(transform->_transform.get_model());
+		}
+		else {
+			model->draw(transform->_transform);
+		}
+	}
+	_em_mutex.unlock();
+
+	draw_models();
 }
 
 void ResourceManager::save() {
 	std::ofstream file;
-	file.open("Data\\Map\\map.txt", std::ios::out | std::ios::trunc);
+	file.open("Data/Map/map.txt", std::ios::out | std::ios::trunc);
 
 	if (!file.is_open()) {
 		std::cout << "save()" << '\n';
-		std::cout << "Couldn't open file Data\\Map\\map.txt" << '\n';
+		std::cout << "Couldn't open file Data/Map/map.txt" << '\n';
 		return;
 	}
 
 	_terrain->save(file);
 
-	save_entities("Data\\Map\\Entities\\");
+	save_entities("Data/Map/Entities/");
 
 	file.close();
 }
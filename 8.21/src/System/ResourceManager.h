@@ -10,12 +10,21 @@
 #include <memory>
 #include <mutex>
 
+#include "../src/Utility/SlotMap.h"
+#include "../src/Utility/SpatialGrid.h"
+#include "../src/Utility/Frustum.h"
+#include "../src/Resources/MeshBuffer.h"
+
 struct GUIIcon;
 struct Texture;
 struct Program;
 class Model;
+class Mesh;
 class Terrain;
+class TerrainData;
 class Entity;
+class Pathfinder;
+class TransformComponent;
 
 /********************************************************************************************************************************************************/
 
@@ -42,9 +51,13 @@ public:
 	~MapManager();
 
 	std::shared_ptr<Terrain> get_terrain();
+	std::shared_ptr<TerrainData> get_terrain_data();
+	std::shared_ptr<Pathfinder> get_pathfinder();
 protected:
 	void load_map();
 	std::shared_ptr<Terrain> _terrain;
+	std::shared_ptr<TerrainData> _terrain_data; // _terrain or height map only on server
+	std::shared_ptr<Pathfinder> _pathfinder;
 private:
 };
 
@@ -76,11 +89,28 @@ public:
 	~ModelManager();
 
 	std::shared_ptr<Model> get_model(int key);
+	MeshBuffer* get_mesh_buffer();
+
+	// every instance queued with Model::add_instance() -- one glMultiDrawElementsIndirect per program and texture set
+	void draw_models();
 protected:
 	void load_models();
 	bool load_model(int id, std::string_view file_path);
+
+	// before _models -- their meshes point into it
+	std::unique_ptr<MeshBuffer> _mesh_buffer;
 	std::map<int, std::shared_ptr<Model>> _models;
 private:
+	struct ModelDraw {
+		GLuint program;
+		Mesh* mesh;
+		DrawElementsCommand command;
+	};
+
+	// reused every draw_models()
+	std::vector<glm::mat4> _instance_data;
+	std::vector<ModelDraw> _draws;
+	std::vector<DrawElementsCommand> _commands;
 };
 
 /********************************************************************************************************************************************************/
@@ -98,15 +128,32 @@ public:
 	void load_entities();
 
 	void add_entity(std::shared_ptr<Entity> entity);
+	void add_entities(const std::vector<std::shared_ptr<Entity>>& entities);
 	std::shared_ptr<Entity> new_entity(std::string_view type, int id);
 	std::shared_ptr<Entity> get_default_entity(std::string_view type, unsigned int id);
 
 	void remove_entity(std::shared_ptr<Entity> entity);
+	void remove_entities(const std::vector<SlotId>& ids);
+
+	SlotMap<std::shared_ptr<Entity>>* get_entities();
 
-	std::unordered_map<int, std::shared_ptr<Entity>>* get_entities();
+	// spatial queries -- see SpatialGrid
+	std::vector<std::shared_ptr<Entity>> query_box(const CollisionBox& box);
+	std::vector<std::shared_ptr<Entity>> query_radius(glm::vec3 center, float radius);
+	// nearest first
+	std::vector<std::shared_ptr<Entity>> query_ray(glm::vec3 origin, glm::vec3 dir, float max_distance);
 protected:
-	//std::vector<std::shared_ptr<Entity>> _entities;
-	std::unordered_map<int, std::shared_ptr<Entity>> _entities;
+	// _em_mutex held
+	void index_entity(SlotId id, const std::shared_ptr<Entity>& entity);
+	void update_spatial_grid();
+	std::vector<std::shared_ptr<Entity>> resolve_query();
+
+	// keyed by unique id -- the editor hands ids out, the engine mirrors the server's
+	SlotMap<std::shared_ptr<Entity>> _entities;
+
+	// every entity with a transform -- sized to the map by load_resources()
+	SpatialGrid _spatial_grid;
+	std::vector<SlotId> _query_ids;
 
 	// <Type, <ID, Entity>>
 	std::map<std::string, std::map<unsigned int, std::shared_ptr<Entity>>> _default_entities;
@@ -128,6 +175,12 @@ public:
 
 	void save();
 private:
+	Frustum _frustum;
+
+	// reused every draw() -- one box per entity with a transform, culled together
+	CollisionBatch _draw_boxes;
+	std::vector<TransformComponent*> _draw_transforms;
+	std::vector<int> _visible;
 };
 
 /********************************************************************************************************************************************************/
@@ -2,14 +2,22 @@
 
 #include "../src/Utility/FileReader.h"
 
-#include <Windows.h>
-#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cmath>
 #include <ctime>
+#include <thread>
 
 #define FILE_CLOCK_FPS "i_clock_fps"
 
 #define DEFAULT_FPS_LIMIT 60
 
+// seconds since first call -- replaces glfwGetTime() so the clock works
+// without glfwInit() (headless server)
+double clock_seconds() {
+	static const auto start = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
 int clock_load_cap(const char* file_path) {
 	FileReader file(file_path);
 
@@ -28,7 +36,9 @@ Clock::Clock(const int fps) :
 	_update_ticks	( 0 ),
 	_fms			( 0.0 ),
 	_ticks			( 0.0 ),
-	_previous_ticks ( glfwGetTime() )
+	_previous_ticks ( clock_seconds() ),
+	_step			( 1.0 / DEFAULT_STEP_RATE ),
+	_accumulator	( 0.0 )
 {}
 
 bool Clock::update(const double interval) {
@@ -38,7 +48,7 @@ bool Clock::update(const double interval) {
 	if (_is_limit && (_time < _ms)) {
 		double delay = _ms - _time;
 		if (delay > 0.0) {
-			Sleep(DWORD(delay));
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
 			update_time();
 		}
 	}
@@ -68,10 +78,32 @@ void Clock::set_limit(const int limit) {
 	_ms = 1000.0 / _limit;
 }
 
+void Clock::set_step(const double step) {
+	_step = step;
+	_accumulator = 0.0;
+}
+
+double Clock::get_step() {
+	return _step;
+}
+
+int Clock::steps() {
+	int steps = (int)(_accumulator / _step);
+	_accumulator -= steps * _step;
+
+	if (steps > MAX_CLOCK_STEPS) {
+		steps = MAX_CLOCK_STEPS;
+		_accumulator = 0.0;
+	}
+
+	return steps;
+}
+
 void Clock::update_time() {
-	_ticks = glfwGetTime() - _previous_ticks;
-	_previous_ticks = glfwGetTime();
+	_ticks = clock_seconds() - _previous_ticks;
+	_previous_ticks = clock_seconds();
 	_time = _ticks * .001;
+	_accumulator += _ticks;
 }
 
 double Clock::get_time() {
@@ -85,11 +117,11 @@ double Clock::get_fms() {
 // Time format (00:00:00:000)
 // days : hours : minutes : seconds : miliseconds
 std::string Clock::get_display_time() {
-	double miliseconds = glfwGetTime() * .001;
+	double miliseconds = clock_seconds() * .001;
 	miliseconds = miliseconds - floor(miliseconds);
 	miliseconds *= 1000.0;
 
-	const int ticks = (int)(glfwGetTime() * .001);
+	const int ticks = (int)(clock_seconds() * .001);
 	const int seconds = ticks % 60;
 	const int minutes = int(ticks / 60) % 60;
 	const int hours = int(ticks / 3600) % 24;
@@ -110,7 +142,11 @@ std::string Clock::get_system_time() {
 	time_t sys_time = time(NULL);
 	std::string str;
 	str.resize(26);
+#ifdef _WIN32
 	ctime_s(&str[0], str.size(), &sys_time);
+#else
+	ctime_r(&sys_time, &str[0]);
+#endif
 
 	str.resize(str.find('\n'));
 
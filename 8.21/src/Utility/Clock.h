@@ -5,10 +5,18 @@
 
 #define UPDATE_INTERVAL 1
 
+// fixed simulation steps per second unless set_step() is called
+#define DEFAULT_STEP_RATE 60
+
+// most steps steps() returns in one frame -- a longer stall is dropped rather than caught up
+#define MAX_CLOCK_STEPS 5
+
 #define CLOCK_FILE "Data/system.txt"
 
 int clock_load_cap(const char* file_path = CLOCK_FILE);
 
+double clock_seconds();
+
 class Clock {
 public:
 	Clock(const int fps = clock_load_cap());
@@ -22,6 +30,13 @@ public:
 	void limit(const bool limit);
 	void set_limit(const int limit);
 
+	// fixed simulation step -- seconds
+	void set_step(const double step);
+	double get_step();
+
+	// fixed steps due since the last call -- leftover time carries over
+	int steps();
+
 	double get_time();
 	double get_fms();
 
@@ -34,6 +49,9 @@ private:
 	double _ticks, _previous_ticks, _update_ticks;
 	bool _is_limit;
 
+	double _step;
+	double _accumulator;
+
 	void update_time();
 };
 
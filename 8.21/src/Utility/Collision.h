@@ -3,10 +3,59 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 struct CollisionBox {
 	glm::vec3 min, max;
 };
 
+// Boxes as one array per bound -- padded to a multiple of 4 with boxes that never overlap
+struct CollisionBatch {
+	std::vector<float> min_x, min_y, min_z;
+	std::vector<float> max_x, max_y, max_z;
+
+	void clear() {
+		min_x.clear();
+		min_y.clear();
+		min_z.clear();
+		max_x.clear();
+		max_y.clear();
+		max_z.clear();
+	}
+
+	void push(const CollisionBox& box) {
+		min_x.push_back(box.min.x);
+		min_y.push_back(box.min.y);
+		min_z.push_back(box.min.z);
+		max_x.push_back(box.max.x);
+		max_y.push_back(box.max.y);
+		max_z.push_back(box.max.z);
+	}
+
+	void set(int i, const CollisionBox& box) {
+		min_x[i] = box.min.x;
+		min_y[i] = box.min.y;
+		min_z[i] = box.min.z;
+		max_x[i] = box.max.x;
+		max_y[i] = box.max.y;
+		max_z[i] = box.max.z;
+	}
+
+	// min above max -- fails every overlap test
+	void pad() {
+		const float big = std::numeric_limits<float>::max();
+		while (min_x.size() % 4) {
+			push({ glm::vec3(big), glm::vec3(-big) });
+		}
+	}
+
+	int size() const {
+		return (int)min_x.size();
+	}
+};
+
 inline bool collision(CollisionBox a, CollisionBox b) {
 	return !(a.max.x <= b.min.x || a.min.x >= b.max.x ||
 			 a.max.y <= b.min.y || a.min.y >= b.max.y ||
@@ -18,4 +67,41 @@ inline bool xz_collision(CollisionBox a, CollisionBox b) {
 		   	  a.max.z <= b.min.z || a.min.z >= b.max.z );
 }
 
+// circle on xz against the box's xz rectangle
+inline bool xz_radius_collision(glm::vec3 center, float radius, CollisionBox b) {
+	const float x = std::clamp(center.x, b.min.x, b.max.x) - center.x;
+	const float z = std::clamp(center.z, b.min.z, b.max.z) - center.z;
+	return x * x + z * z <= radius * radius;
+}
+
+// slab test -- t is the distance along dir to where the ray enters the box, 0 if it starts inside
+inline bool ray_collision(glm::vec3 origin, glm::vec3 dir, CollisionBox b, float* t) {
+	float t_min = 0.0f;
+	float t_max = std::numeric_limits<float>::max();
+
+	for (int i = 0; i < 3; ++i) {
+		if (dir[i] == 0.0f) {
+			if (origin[i] < b.min[i] || origin[i] > b.max[i]) {
+				return false;
+			}
+			continue;
+		}
+
+		float t1 = (b.min[i] - origin[i]) / dir[i];
+		float t2 = (b.max[i] - origin[i]) / dir[i];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+
+		t_min = std::max(t_min, t1);
+		t_max = std::min(t_max, t2);
+		if (t_min > t_max) {
+			return false;
+		}
+	}
+
+	*t = t_min;
+	return true;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+
+#include "Pathfinder.h"
+
+FlowField::FlowField() :
+	_goal			( 0, 0 ),
+	_width			( 0 )
+{}
+
+// dijkstra out from the goal -- a tile's next step is the tile it was reached from
+void FlowField::build(std::shared_ptr<const WalkGrid> grid, glm::ivec2 goal) {
+	_grid = std::move(grid);
+	_goal = goal;
+	_width = _grid->get_width();
+
+	const int length = _grid->get_length();
+	const int size = _width * length;
+
+	_cost.assign(size, FLT_MAX);
+	_next.assign(size, -1);
+
+	if (size == 0) {
+		return;
+	}
+
+	typedef std::pair<float, int> Open;
+	std::vector<Open> open;
+
+	const int goal_node = goal.y * _width + goal.x;
+	_cost[goal_node] = 0.0f;
+	open.push_back({ 0.0f, goal_node });
+
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Open>());
+		const auto [cost, node] = open.back();
+		open.pop_back();
+
+		// a cheaper copy was already expanded
+		if (cost > _cost[node]) {
+			continue;
+		}
+
+		const int x = node % _width;
+		const int z = node / _width;
+
+		for (int dz = -1; dz <= 1; ++dz) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				const int nx = x + dx;
+				const int nz = z + dz;
+				if ((dx == 0 && dz == 0) || !_grid->walkable(nx, nz)) {
+					continue;
+				}
+
+				const bool diagonal = dx != 0 && dz != 0;
+				if (diagonal && (!_grid->walkable(nx, z) || !_grid->walkable(x, nz))) {
+					continue;
+				}
+
+				const int neighbour = nz * _width + nx;
+				const float neighbour_cost = cost + (diagonal ? PATH_DIAGONAL_COST : 1.0f);
+				if (neighbour_cost < _cost[neighbour]) {
+					_cost[neighbour] = neighbour_cost;
+					_next[neighbour] = node;
+
+					open.push_back({ neighbour_cost, neighbour });
+					std::push_heap(open.begin(), open.end(), std::greater<Open>());
+				}
+			}
+		}
+	}
+}
+
+bool FlowField::next(glm::vec3 position, glm::vec3* target) const {
+	if (_width == 0) {
+		return false;
+	}
+
+	const int node = tile_node(position);
+	if (node == _goal.y * _width + _goal.x) {
+		*target = _grid->get_position(_goal);
+		return true;
+	}
+
+	const int next_node = step(node);
+	if (next_node == -1) {
+		return false;
+	}
+
+	const glm::ivec2 tile(next_node % _width, next_node / _width);
+	if (!_grid->walkable(tile.x, tile.y)) {
+		return false;
+	}
+
+	*target = _grid->get_position(tile);
+	return true;
+}
+
+bool FlowField::at_goal(glm::vec3 position) const {
+	return _width != 0 && tile_node(position) == _goal.y * _width + _goal.x;
+}
+
+bool FlowField::reaches(glm::vec3 position) const {
+	if (_width == 0) {
+		return false;
+	}
+
+	const int node = tile_node(position);
+	return _cost[node] < FLT_MAX || step(node) != -1;
+}
+
+const std::shared_ptr<const WalkGrid>& FlowField::get_grid() const {
+	return _grid;
+}
+
+glm::ivec2 FlowField::get_goal() const {
+	return _goal;
+}
+
+int FlowField::tile_node(glm::vec3 position) const {
+	const glm::ivec2 tile = _grid->get_tile(position);
+	return tile.y * _width + tile.x;
+}
+
+// units pushed off the walkable tiles still find their way back on
+int FlowField::step(int node) const {
+	const int x = node % _width;
+	const int z = node / _width;
+
+	if (_cost[node] < FLT_MAX || _grid->walkable(x, z)) {
+		return _next[node];
+	}
+
+	int best = -1;
+	float best_cost = FLT_MAX;
+	for (int dz = -1; dz <= 1; ++dz) {
+		for (int dx = -1; dx <= 1; ++dx) {
+			const int nx = x + dx;
+			const int nz = z + dz;
+			if (nx < 0 || nx >= _width || nz < 0 || nz >= _grid->get_length()) {
+				continue;
+			}
+
+			const int neighbour = nz * _width + nx;
+			if (_cost[neighbour] < best_cost) {
+				best = neighbour;
+				best_cost = _cost[neighbour];
+			}
+		}
+	}
+
+	return best;
+}
@@ -0,0 +1,44 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <vector>
+#include <memory>
+
+#include <glm/glm.hpp>
+
+class WalkGrid;
+
+// Every tile's next step toward one goal tile -- built once and shared by every unit sent there
+// the cheapest way out from the goal over a WalkGrid, 8 way and never past a blocked corner
+class FlowField {
+public:
+	FlowField();
+
+	// grid is kept -- positions are turned into tiles with it
+	void build(std::shared_ptr<const WalkGrid> grid, glm::ivec2 goal);
+
+	// center of the tile to step onto from position -- the goal tile's own center once on it
+	// false with no way to the goal, or beside a goal that cant be stood on
+	bool next(glm::vec3 position, glm::vec3* target) const;
+
+	bool at_goal(glm::vec3 position) const;
+	bool reaches(glm::vec3 position) const;
+
+	// the snapshot it was built on
+	const std::shared_ptr<const WalkGrid>& get_grid() const;
+	glm::ivec2 get_goal() const;
+private:
+	int tile_node(glm::vec3 position) const;
+	// next tile from node -- -1 at the goal or with no way there
+	// a blocked tile the search never got to steps onto its cheapest neighbour that it did
+	int step(int node) const;
+
+	std::shared_ptr<const WalkGrid> _grid;
+	glm::ivec2 _goal;
+	int _width;
+
+	std::vector<float> _cost;
+	std::vector<int> _next;
+};
+
+#endif
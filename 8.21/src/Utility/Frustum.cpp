@@ -0,0 +1,114 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_SSE
+#endif
+
+Frustum::Frustum() {
+	for (int i = 0; i < FRUSTUM_PLANES; ++i) {
+		_planes[i] = glm::vec4(0.0f);
+	}
+}
+
+// each plane is the last row of the matrix plus or minus one of the others
+void Frustum::update(const glm::mat4& view_projection) {
+	const glm::mat4 m = glm::transpose(view_projection);
+
+	_planes[0] = m[3] + m[0];	// left
+	_planes[1] = m[3] - m[0];	// right
+	_planes[2] = m[3] + m[1];	// bottom
+	_planes[3] = m[3] - m[1];	// top
+	_planes[4] = m[3] + m[2];	// near
+	_planes[5] = m[3] - m[2];	// far
+
+	for (int i = 0; i < FRUSTUM_PLANES; ++i) {
+		const float length = glm::length(glm::vec3(_planes[i]));
+		if (length > 0.0f) {
+			_planes[i] /= length;
+		}
+	}
+}
+
+// the corner furthest along the normal -- if that is behind the plane the whole box is
+bool Frustum::visible(const CollisionBox& box) const {
+	for (int i = 0; i < FRUSTUM_PLANES; ++i) {
+		const glm::vec4& plane = _planes[i];
+		const glm::vec3 corner(
+			plane.x > 0.0f ? box.max.x : box.min.x,
+			plane.y > 0.0f ? box.max.y : box.min.y,
+			plane.z > 0.0f ? box.max.z : box.min.z
+		);
+
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// a plane picks the same corner for every box so the batch's arrays are read straight
+// padding has min above max which puts its corner far behind every plane
+void Frustum::cull(const CollisionBatch& batch, std::vector<int>& visible) const {
+	visible.clear();
+
+	const int count = batch.size();
+
+	const float* corner_x[FRUSTUM_PLANES];
+	const float* corner_y[FRUSTUM_PLANES];
+	const float* corner_z[FRUSTUM_PLANES];
+	for (int i = 0; i < FRUSTUM_PLANES; ++i) {
+		corner_x[i] = _planes[i].x > 0.0f ? batch.max_x.data() : batch.min_x.data();
+		corner_y[i] = _planes[i].y > 0.0f ? batch.max_y.data() : batch.min_y.data();
+		corner_z[i] = _planes[i].z > 0.0f ? batch.max_z.data() : batch.min_z.data();
+	}
+
+#ifdef FRUSTUM_SSE
+	__m128 normal_x[FRUSTUM_PLANES];
+	__m128 normal_y[FRUSTUM_PLANES];
+	__m128 normal_z[FRUSTUM_PLANES];
+	__m128 distance[FRUSTUM_PLANES];
+	for (int i = 0; i < FRUSTUM_PLANES; ++i) {
+		normal_x[i] = _mm_set1_ps(_planes[i].x);
+		normal_y[i] = _mm_set1_ps(_planes[i].y);
+		normal_z[i] = _mm_set1_ps(_planes[i].z);
+		distance[i] = _mm_set1_ps(_planes[i].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (int i = 0; i < count; i += 4) {
+		__m128 outside = _mm_setzero_ps();
+		for (int j = 0; j < FRUSTUM_PLANES; ++j) {
+			__m128 dot = _mm_add_ps(_mm_mul_ps(normal_x[j], _mm_loadu_ps(corner_x[j] + i)), distance[j]);
+			dot = _mm_add_ps(dot, _mm_mul_ps(normal_y[j], _mm_loadu_ps(corner_y[j] + i)));
+			dot = _mm_add_ps(dot, _mm_mul_ps(normal_z[j], _mm_loadu_ps(corner_z[j] + i)));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(dot, zero));
+		}
+
+		const int mask = ~_mm_movemask_ps(outside) & 0xF;
+		if (!mask) {
+			continue;
+		}
+
+		for (int j = 0; j < 4; ++j) {
+			if (mask & (1 << j)) {
+				visible.push_back(i + j);
+			}
+		}
+	}
+#else
+	for (int i = 0; i < count; ++i) {
+		bool inside = true;
+		for (int j = 0; j < FRUSTUM_PLANES && inside; ++j) {
+			const float dot = _planes[j].x * corner_x[j][i] + _planes[j].y * corner_y[j][i] + _planes[j].z * corner_z[j][i] + _planes[j].w;
+			inside = dot >= 0.0f;
+		}
+
+		if (inside) {
+			visible.push_back(i);
+		}
+	}
+#endif
+}
@@ -0,0 +1,30 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../src/Utility/Collision.h"
+
+#define FRUSTUM_PLANES 6
+
+// The six planes of a camera's view -- boxes wholly behind any one of them cant be seen
+// a box in front of every plane is kept even when it sits past a corner, it only ever errs toward drawing
+class Frustum {
+public:
+	Frustum();
+
+	// projection * view -- normals point inward and have length 1
+	void update(const glm::mat4& view_projection);
+
+	bool visible(const CollisionBox& box) const;
+
+	// indices of the boxes in batch that can be seen -- pad() boxes never are
+	void cull(const CollisionBatch& batch, std::vector<int>& visible) const;
+private:
+	// xyz the normal, w the distance
+	glm::vec4 _planes[FRUSTUM_PLANES];
+};
+
+#endif
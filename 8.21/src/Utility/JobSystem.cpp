@@ -0,0 +1,160 @@
+#include "JobSystem.h"
+
+#include <chrono>
+
+// how long an idle worker sleeps before looking for work again
+constexpr auto JOB_IDLE_WAIT = std::chrono::milliseconds(1);
+
+int job_default_workers() {
+	const int threads = (int)std::thread::hardware_concurrency();
+	return threads > 1 ? threads - 1 : 0;
+}
+
+JobSystem::JobSystem(const int workers) :
+	_running			( true ),
+	_queued				( 0 ),
+	_background_queued	( 0 )
+{
+	const int count = std::max(workers, 0);
+
+	_queues.reserve(count + 1);
+	for (int i = 0; i <= count; ++i) {
+		_queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	_threads.reserve(count);
+	for (int i = 1; i <= count; ++i) {
+		_threads.emplace_back(&JobSystem::worker, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	_running = false;
+	_wake.notify_all();
+
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+
+	// whatever is left still runs so nobody waits on a counter forever
+	Job job;
+	while (next(0, job) || next_background(job)) {
+		execute(job);
+	}
+}
+
+// spread across the queues so workers start without having to steal
+void JobSystem::run(std::function<void()> job, JobCounter* counter) {
+	static std::atomic<unsigned int> next_queue(0);
+
+	counter->_count.fetch_add(1, std::memory_order_relaxed);
+
+	WorkQueue& queue = *_queues[next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size()];
+	queue.mutex.lock();
+	queue.jobs.push_back({ std::move(job), counter });
+	queue.mutex.unlock();
+
+	_queued.fetch_add(1, std::memory_order_release);
+	_wake.notify_one();
+}
+
+void JobSystem::run_background(std::function<void()> job, JobCounter* counter) {
+	counter->_count.fetch_add(1, std::memory_order_relaxed);
+
+	if (_threads.empty()) {
+		Job inline_job = { std::move(job), counter };
+		execute(inline_job);
+		return;
+	}
+
+	_background.mutex.lock();
+	_background.jobs.push_back({ std::move(job), counter });
+	_background.mutex.unlock();
+
+	_background_queued.fetch_add(1, std::memory_order_release);
+	_wake.notify_one();
+}
+
+void JobSystem::wait(JobCounter* counter) {
+	Job job;
+	while (!counter->done()) {
+		if (next(0, job)) {
+			execute(job);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+int JobSystem::get_threads() {
+	return (int)_queues.size();
+}
+
+void JobSystem::worker(int index) {
+	Job job;
+	while (_running) {
+		if (next(index, job) || next_background(job)) {
+			execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleep_mutex);
+		_wake.wait_for(lock, JOB_IDLE_WAIT, [this]() {
+			return !_running || _queued.load(std::memory_order_acquire) > 0 || _background_queued.load(std::memory_order_acquire) > 0;
+		});
+	}
+}
+
+// own queue newest first, then the oldest job of every other queue
+bool JobSystem::next(int index, Job& job) {
+	if (_queued.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	const int count = (int)_queues.size();
+	for (int i = 0; i < count; ++i) {
+		WorkQueue& queue = *_queues[(index + i) % count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty()) {
+			continue;
+		}
+
+		if (i == 0) {
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else {
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+// oldest first
+bool JobSystem::next_background(Job& job) {
+	if (_background_queued.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_background.mutex);
+	if (_background.jobs.empty()) {
+		return false;
+	}
+
+	job = std::move(_background.jobs.front());
+	_background.jobs.pop_front();
+
+	_background_queued.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+void JobSystem::execute(Job& job) {
+	job.func();
+	job.counter->_count.fetch_sub(1, std::memory_order_release);
+}
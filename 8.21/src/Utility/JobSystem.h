@@ -0,0 +1,107 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+// ranges per thread parallel_for() aims for -- spare ranges are what idle threads steal
+#define JOB_RANGES_PER_THREAD 4
+
+// hardware threads - 1 -- the thread calling wait() is the last one
+int job_default_workers();
+
+// jobs of one batch still to finish
+class JobCounter {
+public:
+	JobCounter() : _count(0) {}
+
+	bool done() const { return _count.load(std::memory_order_acquire) == 0; }
+private:
+	std::atomic<int> _count;
+
+	friend class JobSystem;
+};
+
+// Work stealing thread pool
+// every thread has its own queue -- it pops its newest job, idle threads steal the oldest from the others
+class JobSystem {
+public:
+	JobSystem(const int workers = job_default_workers());
+	~JobSystem();
+
+	void run(std::function<void()> job, JobCounter* counter);
+
+	// only idle workers take it and wait() never does, so it cant hold up a parallel_for
+	// with no workers it runs before returning
+	void run_background(std::function<void()> job, JobCounter* counter);
+
+	// runs queued jobs on the calling thread until counter is done
+	void wait(JobCounter* counter);
+
+	// splits [begin, end) into ranges of at least grain and blocks until func(range_begin, range_end) ran for all of them
+	template<typename Func>
+	void parallel_for(int begin, int end, int grain, Func func);
+
+	// workers + the calling thread
+	int get_threads();
+private:
+	struct Job {
+		std::function<void()> func;
+		JobCounter* counter;
+	};
+
+	struct WorkQueue {
+		std::deque<Job> jobs;
+		std::mutex mutex;
+	};
+
+	void worker(int index);
+	bool next(int index, Job& job);
+	bool next_background(Job& job);
+	void execute(Job& job);
+
+	// queue 0 belongs to whichever thread calls run() / wait()
+	std::vector<std::unique_ptr<WorkQueue>> _queues;
+	WorkQueue _background;
+	std::vector<std::thread> _threads;
+
+	std::atomic<bool> _running;
+	std::atomic<int> _queued;
+	std::atomic<int> _background_queued;
+
+	std::mutex _sleep_mutex;
+	std::condition_variable _wake;
+};
+
+template<typename Func>
+void JobSystem::parallel_for(int begin, int end, int grain, Func func) {
+	const int count = end - begin;
+	if (count <= 0) {
+		return;
+	}
+
+	const int threads = get_threads();
+	const int size = std::max(grain, (count + threads * JOB_RANGES_PER_THREAD - 1) / (threads * JOB_RANGES_PER_THREAD));
+
+	if (threads == 1 || size >= count) {
+		func(begin, end);
+		return;
+	}
+
+	JobCounter counter;
+	for (int b = begin; b < end; b += size) {
+		const int e = std::min(end, b + size);
+		run([&func, b, e]() { func(b, e); }, &counter);
+	}
+
+	wait(&counter);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// Lock-free multi producer / single consumer queue (Vyukov)
+// push() from any thread -- pop() / drain() from one consumer thread only
+template <class T>
+class MPSCQueue {
+public:
+	MPSCQueue();
+	~MPSCQueue();
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	void push(T value);
+	bool pop(T& value);
+
+	// pops everything queued so far -- returns the number of items
+	template <class Func>
+	int drain(Func func);
+private:
+	struct Node {
+		std::atomic<Node*> next{ nullptr };
+		T value;
+	};
+
+	// producers swap the newest node in here
+	alignas(64) std::atomic<Node*> _head;
+	// consumer only -- the stub / last popped node
+	alignas(64) Node* _tail;
+};
+
+template <class T>
+MPSCQueue<T>::MPSCQueue() :
+	_head			( new Node ),
+	_tail			( _head.load(std::memory_order_relaxed) )
+{}
+
+template <class T>
+MPSCQueue<T>::~MPSCQueue() {
+	while (_tail) {
+		Node* next = _tail->next.load(std::memory_order_relaxed);
+		delete _tail;
+		_tail = next;
+	}
+}
+
+template <class T>
+void MPSCQueue<T>::push(T value) {
+	Node* node = new Node;
+	node->value = std::move(value);
+
+	Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+	prev->next.store(node, std::memory_order_release);
+}
+
+// false if empty -- or if a producer is between its exchange and store, the item shows up on the next pop
+template <class T>
+bool MPSCQueue<T>::pop(T& value) {
+	Node* tail = _tail;
+	Node* next = tail->next.load(std::memory_order_acquire);
+	if (!next) {
+		return false;
+	}
+
+	value = std::move(next->value);
+	_tail = next;
+	delete tail;
+
+	return true;
+}
+
+template <class T>
+template <class Func>
+int MPSCQueue<T>::drain(Func func) {
+	int count = 0;
+	T value;
+	while (pop(value)) {
+		func(value);
+		++count;
+	}
+	return count;
+}
+
+#endif
@@ -0,0 +1,838 @@
+#include "Pathfinder.h"
+#include "FlowField.h"
+
+#include <algorithm>
+#include <functional>
+#include <climits>
+#include <cmath>
+#include <thread>
+
+#include "../src/System/Environment.h"
+#include "../src/Resources/Terrain.h"
+
+/********************************************************************************************************************************************************/
+
+WalkGrid::WalkGrid() :
+	_width			( 0 ),
+	_length			( 0 ),
+	_tile_width		( 1.0f ),
+	_tile_length	( 1.0f )
+{}
+
+void WalkGrid::build(TerrainData* terrain) {
+	_terrain.clear();
+	_occupied.clear();
+
+	if (!terrain) {
+		_width = 0;
+		_length = 0;
+		return;
+	}
+
+	_width = terrain->get_width();
+	_length = terrain->get_length();
+	_tile_width = terrain->get_tile_width();
+	_tile_length = terrain->get_tile_length();
+
+	_terrain.resize(_width * _length);
+	_occupied.resize(_width * _length, 0);
+
+	for (int z = 0; z < _length; ++z) {
+		for (int x = 0; x < _width; ++x) {
+			_terrain[z * _width + x] = terrain->is_walkable(x, z);
+		}
+	}
+}
+
+void WalkGrid::update_tile(TerrainData* terrain, int x, int z) {
+	if (x < 0 || x >= _width || z < 0 || z >= _length) {
+		return;
+	}
+
+	_terrain[z * _width + x] = terrain->is_walkable(x, z);
+}
+
+// every tile the box covers on xz -- a box ending exactly on a tile edge doesnt take the next tile
+void WalkGrid::occupy(const CollisionBox& box, int count) {
+	if (_width == 0) {
+		return;
+	}
+
+	const int min_x = std::max(0, (int)std::floor(box.min.x / _tile_width));
+	const int min_z = std::max(0, (int)std::floor(box.min.z / _tile_length));
+	const int max_x = std::min(_width - 1, (int)std::ceil(box.max.x / _tile_width) - 1);
+	const int max_z = std::min(_length - 1, (int)std::ceil(box.max.z / _tile_length) - 1);
+
+	for (int z = min_z; z <= max_z; ++z) {
+		for (int x = min_x; x <= max_x; ++x) {
+			uint16_t& occupied = _occupied[z * _width + x];
+			occupied = (uint16_t)std::max(0, occupied + count);
+		}
+	}
+}
+
+bool WalkGrid::walkable(int x, int z) const {
+	if (x < 0 || x >= _width || z < 0 || z >= _length) {
+		return false;
+	}
+
+	const int index = z * _width + x;
+	return _terrain[index] && !_occupied[index];
+}
+
+glm::ivec2 WalkGrid::get_tile(glm::vec3 position) const {
+	const int x = (int)std::floor(position.x / _tile_width);
+	const int z = (int)std::floor(position.z / _tile_length);
+
+	return glm::ivec2(std::clamp(x, 0, std::max(0, _width - 1)), std::clamp(z, 0, std::max(0, _length - 1)));
+}
+
+glm::vec3 WalkGrid::get_position(glm::ivec2 tile) const {
+	return glm::vec3((tile.x + 0.5f) * _tile_width, 0.0f, (tile.y + 0.5f) * _tile_length);
+}
+
+int WalkGrid::get_width() const {
+	return _width;
+}
+
+int WalkGrid::get_length() const {
+	return _length;
+}
+
+/********************************************************************************************************************************************************/
+
+PathSearch::PathSearch() :
+	_grid			( nullptr ),
+	_width			( 0 ),
+	_goal			( 0, 0 ),
+	_search			( 0 )
+{}
+
+bool PathSearch::find(const WalkGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& points, bool* reached) {
+	points.clear();
+	*reached = false;
+
+	const int size = grid.get_width() * grid.get_length();
+	if (size == 0) {
+		return false;
+	}
+
+	if ((int)_g.size() != size) {
+		_g.assign(size, 0.0f);
+		_parent.assign(size, -1);
+		_opened.assign(size, 0);
+		_closed.assign(size, 0);
+		_search = 0;
+	}
+
+	// wrapped -- old stamps could match the new search
+	if (++_search == 0) {
+		std::fill(_opened.begin(), _opened.end(), 0);
+		std::fill(_closed.begin(), _closed.end(), 0);
+		_search = 1;
+	}
+
+	_grid = &grid;
+	_width = grid.get_width();
+	_goal = goal;
+
+	const int start_node = start.y * _width + start.x;
+	const int goal_node = goal.y * _width + goal.x;
+
+	_open.clear();
+	open(start_node, -1, 0.0f);
+
+	// closest tile to the goal so far -- the path ends there if the goal cant be reached
+	int best = start_node;
+	float best_h = heuristic(start_node);
+
+	while (!_open.empty()) {
+		std::pop_heap(_open.begin(), _open.end(), std::greater<Open>());
+		const int node = _open.back().node;
+		_open.pop_back();
+
+		// a cheaper copy was already expanded
+		if (_closed[node] == _search) {
+			continue;
+		}
+		_closed[node] = _search;
+
+		if (node == goal_node) {
+			best = node;
+			*reached = true;
+			break;
+		}
+
+		const float h = heuristic(node);
+		if (h < best_h) {
+			best = node;
+			best_h = h;
+		}
+
+		successors(node);
+	}
+
+	if (!*reached && best == start_node) {
+		return false;
+	}
+
+	for (int node = best; node != -1; node = _parent[node]) {
+		points.push_back(glm::ivec2(node % _width, node / _width));
+	}
+	std::reverse(points.begin(), points.end());
+
+	return true;
+}
+
+bool PathSearch::walkable(int x, int z) const {
+	return _grid->walkable(x, z);
+}
+
+// straight runs stop where a wall beside them ends -- diagonal runs stop where either straight run finds something
+int PathSearch::jump(int x, int z, int dx, int dz) {
+	while (true) {
+		if (!walkable(x, z)) {
+			return -1;
+		}
+
+		if (x == _goal.x && z == _goal.y) {
+			return z * _width + x;
+		}
+
+		if (dx != 0 && dz != 0) {
+			if (jump(x + dx, z, dx, 0) != -1 || jump(x, z + dz, 0, dz) != -1) {
+				return z * _width + x;
+			}
+		}
+		else if (dx != 0) {
+			if ((walkable(x, z - 1) && !walkable(x - dx, z - 1)) ||
+				(walkable(x, z + 1) && !walkable(x - dx, z + 1))) {
+				return z * _width + x;
+			}
+		}
+		else {
+			if ((walkable(x - 1, z) && !walkable(x - 1, z - dz)) ||
+				(walkable(x + 1, z) && !walkable(x + 1, z - dz))) {
+				return z * _width + x;
+			}
+		}
+
+		// no corner cutting -- both sides of a diagonal step have to be open
+		if (!walkable(x + dx, z + dz) || !walkable(x + dx, z) || !walkable(x, z + dz)) {
+			return -1;
+		}
+
+		x += dx;
+		z += dz;
+	}
+}
+
+void PathSearch::successors(int node) {
+	const int x = node % _width;
+	const int z = node / _width;
+
+	_neighbours.clear();
+	const auto add = [this](int nx, int nz) {
+		if (walkable(nx, nz)) {
+			_neighbours.push_back(nz * _width + nx);
+		}
+	};
+
+	const int parent = _parent[node];
+	if (parent == -1) {
+		for (int dz = -1; dz <= 1; ++dz) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				if ((dx == 0 && dz == 0) || (dx != 0 && dz != 0 && (!walkable(x + dx, z) || !walkable(x, z + dz)))) {
+					continue;
+				}
+				add(x + dx, z + dz);
+			}
+		}
+	}
+	else {
+		// only the directions the parent couldnt have reached as cheaply
+		const int px = parent % _width;
+		const int pz = parent / _width;
+		const int dx = (x > px) - (x < px);
+		const int dz = (z > pz) - (z < pz);
+
+		if (dx != 0 && dz != 0) {
+			const bool next_x = walkable(x + dx, z);
+			const bool next_z = walkable(x, z + dz);
+			if (next_z) {
+				add(x, z + dz);
+			}
+			if (next_x) {
+				add(x + dx, z);
+			}
+			if (next_x && next_z) {
+				add(x + dx, z + dz);
+			}
+		}
+		else if (dx != 0) {
+			const bool up = walkable(x, z - 1);
+			const bool down = walkable(x, z + 1);
+			if (walkable(x + dx, z)) {
+				add(x + dx, z);
+				if (up) {
+					add(x + dx, z - 1);
+				}
+				if (down) {
+					add(x + dx, z + 1);
+				}
+			}
+			if (up) {
+				add(x, z - 1);
+			}
+			if (down) {
+				add(x, z + 1);
+			}
+		}
+		else {
+			const bool left = walkable(x - 1, z);
+			const bool right = walkable(x + 1, z);
+			if (walkable(x, z + dz)) {
+				add(x, z + dz);
+				if (left) {
+					add(x - 1, z + dz);
+				}
+				if (right) {
+					add(x + 1, z + dz);
+				}
+			}
+			if (left) {
+				add(x - 1, z);
+			}
+			if (right) {
+				add(x + 1, z);
+			}
+		}
+	}
+
+	for (const int neighbour : _neighbours) {
+		const int nx = neighbour % _width;
+		const int nz = neighbour / _width;
+
+		const int jump_point = jump(nx, nz, nx - x, nz - z);
+		if (jump_point == -1 || _closed[jump_point] == _search) {
+			continue;
+		}
+
+		const int jx = std::abs(jump_point % _width - x);
+		const int jz = std::abs(jump_point / _width - z);
+		const float cost = (float)(jx + jz) + (PATH_DIAGONAL_COST - 2.0f) * std::min(jx, jz);
+
+		open(jump_point, node, _g[node] + cost);
+	}
+}
+
+void PathSearch::open(int node, int parent, float g) {
+	if (_opened[node] == _search && g >= _g[node]) {
+		return;
+	}
+
+	_opened[node] = _search;
+	_g[node] = g;
+	_parent[node] = parent;
+
+	_open.push_back({ g + heuristic(node), node });
+	std::push_heap(_open.begin(), _open.end(), std::greater<Open>());
+}
+
+// octile distance
+float PathSearch::heuristic(int node) const {
+	const int dx = std::abs(node % _width - _goal.x);
+	const int dz = std::abs(node / _width - _goal.y);
+
+	return (float)(dx + dz) + (PATH_DIAGONAL_COST - 2.0f) * std::min(dx, dz);
+}
+
+/********************************************************************************************************************************************************/
+
+Pathfinder::Pathfinder() :
+	_terrain		( nullptr ),
+	_revision		( 0 ),
+	_serial			( 0 )
+{}
+
+// searches still running point back here
+Pathfinder::~Pathfinder() {
+	while (!_pending.done()) {
+		std::this_thread::yield();
+	}
+}
+
+void Pathfinder::build(TerrainData* terrain) {
+	_terrain = terrain;
+
+	_grid.build(terrain);
+	_published = std::make_shared<const WalkGrid>(_grid);
+	++_revision;
+
+	_dirty.clear();
+	_dirty_flags.assign(_grid.get_width() * _grid.get_length(), 0);
+
+	_cache.clear();
+	_cache_order.clear();
+	_fields.clear();
+}
+
+void Pathfinder::terrain_changed(int x, int z) {
+	for (int dz = -1; dz <= 1; ++dz) {
+		for (int dx = -1; dx <= 1; ++dx) {
+			const int tx = x + dx;
+			const int tz = z + dz;
+			if (tx < 0 || tx >= _grid.get_width() || tz < 0 || tz >= _grid.get_length()) {
+				continue;
+			}
+
+			uint8_t& flag = _dirty_flags[tz * _grid.get_width() + tx];
+			if (!flag) {
+				flag = 1;
+				_dirty.push_back(glm::ivec2(tx, tz));
+			}
+		}
+	}
+}
+
+void Pathfinder::occupy(const CollisionBox& box) {
+	_grid.occupy(box, 1);
+
+	const glm::ivec2 min = _grid.get_tile(box.min);
+	const glm::ivec2 max = _grid.get_tile(box.max);
+	for (int z = min.y; z <= max.y; ++z) {
+		for (int x = min.x; x <= max.x; ++x) {
+			terrain_changed(x, z);
+		}
+	}
+}
+
+void Pathfinder::vacate(const CollisionBox& box) {
+	_grid.occupy(box, -1);
+
+	const glm::ivec2 min = _grid.get_tile(box.min);
+	const glm::ivec2 max = _grid.get_tile(box.max);
+	for (int z = min.y; z <= max.y; ++z) {
+		for (int x = min.x; x <= max.x; ++x) {
+			terrain_changed(x, z);
+		}
+	}
+}
+
+void Pathfinder::request(SlotId id, glm::vec3 from, glm::vec3 to) {
+	if (!_published || _grid.get_width() == 0) {
+		return;
+	}
+
+	ActivePath* active = _active.get(id);
+	if (!active) {
+		if (!_active.insert_at(id, {})) {
+			return;
+		}
+		active = _active.get(id);
+	}
+
+	active->serial = ++_serial;
+	active->from = from;
+	active->to = to;
+	active->waypoints.clear();
+	active->field.reset();
+	active->position = from;
+	active->waypoint = 0;
+
+	start({ id, active->serial, from, to, {}, false });
+}
+
+void Pathfinder::request_group(const std::vector<SlotId>& ids, const std::vector<glm::vec3>& from, glm::vec3 to) {
+	if (!_published || _grid.get_width() == 0 || ids.empty()) {
+		return;
+	}
+
+	// one search is cheaper than a field over the whole map
+	if (ids.size() == 1) {
+		request(ids[0], from[0], to);
+		return;
+	}
+
+	FieldRequest field = { {}, {}, {}, to, FLOW_FIELD_ARRIVE_SPACING * std::sqrt((float)(ids.size() - 1)), false };
+	field.ids.reserve(ids.size());
+	field.serials.reserve(ids.size());
+	field.from.reserve(ids.size());
+
+	for (size_t i = 0; i < ids.size(); ++i) {
+		ActivePath* active = _active.get(ids[i]);
+		if (!active) {
+			if (!_active.insert_at(ids[i], {})) {
+				continue;
+			}
+			active = _active.get(ids[i]);
+		}
+
+		active->serial = ++_serial;
+		active->from = from[i];
+		active->to = to;
+		active->waypoints.clear();
+		active->field.reset();
+		active->position = from[i];
+		active->waypoint = 0;
+
+		field.ids.push_back(ids[i]);
+		field.serials.push_back(active->serial);
+		field.from.push_back(from[i]);
+	}
+
+	start_field(std::move(field));
+}
+
+void Pathfinder::cancel(SlotId id) {
+	_active.erase(id);
+}
+
+void Pathfinder::progress(SlotId id, unsigned int serial, glm::vec3 position, int waypoint) {
+	ActivePath* active = _active.get(id);
+	if (active && active->serial == serial) {
+		active->position = position;
+		active->waypoint = waypoint;
+	}
+}
+
+// a new request since keeps its entry
+void Pathfinder::arrived(SlotId id, unsigned int serial) {
+	const ActivePath* active = _active.get(id);
+	if (active && active->serial == serial) {
+		_active.erase(id);
+	}
+}
+
+void Pathfinder::update(std::vector<PathResult>& results) {
+	apply_changes();
+
+	_found_mutex.lock();
+	_finished.insert(_finished.end(), std::make_move_iterator(_found.begin()), std::make_move_iterator(_found.end()));
+	_found.clear();
+	_finished_fields.insert(_finished_fields.end(), std::make_move_iterator(_found_fields.begin()), std::make_move_iterator(_found_fields.end()));
+	_found_fields.clear();
+	_found_mutex.unlock();
+
+	// finish_field() can add searches to _finished and built fields to _finished_fields
+	for (size_t i = 0; i < _finished_fields.size(); ++i) {
+		FoundField found = std::move(_finished_fields[i]);
+		finish_field(found, results);
+	}
+	_finished_fields.clear();
+
+	// finish() can add cache hits to _finished
+	for (size_t i = 0; i < _finished.size(); ++i) {
+		Found found = std::move(_finished[i]);
+		finish(found, results);
+	}
+	_finished.clear();
+}
+
+// cache hits finish on the next update() -- everything else is searched on a worker
+void Pathfinder::start(Request request) {
+	const glm::ivec2 start = _grid.get_tile(request.from);
+	const glm::ivec2 goal = _grid.get_tile(request.to);
+
+	const auto cached = _cache.find(cache_key(start, goal));
+	if (cached != _cache.end()) {
+		_finished.push_back({ std::move(request), _revision, cached->second.tiles, cached->second.reached, true });
+		return;
+	}
+
+	const auto job = [this, grid = _published, revision = _revision, request, start, goal]() {
+		Found found = { request, revision, {}, false, false };
+
+		auto search = acquire_search();
+		found.found = search->find(*grid, start, goal, found.tiles, &found.reached);
+		release_search(std::move(search));
+
+		std::lock_guard<std::mutex> lock(_found_mutex);
+		_found.push_back(std::move(found));
+	};
+
+	if (const auto jobs = Environment::get().get_job_system()) {
+		jobs->run_background(job, &_pending);
+	}
+	else {
+		job();
+	}
+}
+
+void Pathfinder::finish(Found& found, std::vector<PathResult>& results) {
+	const SlotId id = found.request.id;
+
+	// cancelled or asked for again since
+	ActivePath* active = _active.get(id);
+	if (!active || active->serial != found.request.serial) {
+		return;
+	}
+
+	if (!found.found) {
+		active->waypoints.clear();
+		return;
+	}
+
+	// searched on a grid that has changed since -- search again if it crosses the change
+	if (found.revision != _revision) {
+		for (size_t i = 1; i < found.tiles.size(); ++i) {
+			if (!segment_walkable(found.tiles[i - 1], found.tiles[i])) {
+				start(std::move(found.request));
+				return;
+			}
+		}
+	}
+
+	const uint64_t key = cache_key(found.tiles.front(), _grid.get_tile(found.request.to));
+	if (!_cache.count(key)) {
+		_cache[key] = { found.tiles, found.reached, tile_bounds(found.tiles) };
+		_cache_order.push_back(key);
+
+		if (_cache_order.size() > PATH_CACHE_SIZE) {
+			_cache.erase(_cache_order.front());
+			_cache_order.pop_front();
+		}
+	}
+
+	// the unit keeps its place if it hasnt reached where the repair starts -- as TransformComponent::set_path()
+	const int first = (int)found.request.prefix.size();
+	if (found.request.repair) {
+		active->waypoint = std::min(active->waypoint, first);
+	}
+
+	active->waypoints = to_waypoints(found);
+	results.push_back({ id, active->waypoints, first, nullptr, 0.0f, found.request.repair, active->serial });
+}
+
+// a field already built to the same tile on this grid finishes on the next update() -- otherwise it is built on a worker
+void Pathfinder::start_field(FieldRequest request) {
+	const glm::ivec2 goal = _grid.get_tile(request.to);
+
+	const auto cached = _fields.find(goal.y * _grid.get_width() + goal.x);
+	if (cached != _fields.end()) {
+		if (auto field = cached->second.lock()) {
+			_finished_fields.push_back({ std::move(request), std::move(field) });
+			return;
+		}
+	}
+
+	const auto job = [this, grid = _published, request, goal]() {
+		auto field = std::make_shared<FlowField>();
+		field->build(grid, goal);
+
+		std::lock_guard<std::mutex> lock(_found_mutex);
+		_found_fields.push_back({ request, std::move(field) });
+	};
+
+	if (const auto jobs = Environment::get().get_job_system()) {
+		jobs->run_background(job, &_pending);
+	}
+	else {
+		job();
+	}
+}
+
+void Pathfinder::finish_field(FoundField& found, std::vector<PathResult>& results) {
+	FieldRequest& request = found.request;
+
+	// built on a grid that has changed since
+	if (found.field->get_grid() != _published) {
+		start_field(std::move(request));
+		return;
+	}
+
+	const glm::ivec2 goal = found.field->get_goal();
+	auto& cached = _fields[goal.y * _grid.get_width() + goal.x];
+	if (cached.expired()) {
+		cached = found.field;
+	}
+
+	for (size_t i = 0; i < request.ids.size(); ++i) {
+		const SlotId id = request.ids[i];
+
+		// cancelled or asked for again since
+		ActivePath* active = _active.get(id);
+		if (!active || active->serial != request.serials[i]) {
+			continue;
+		}
+
+		// cut off from the goal -- a search still gets it as close as it can
+		if (!request.repair && !found.field->reaches(request.from[i])) {
+			start({ id, active->serial, request.from[i], request.to, {}, false });
+			continue;
+		}
+
+		active->field = found.field;
+		results.push_back({ id, { request.to }, 0, found.field, request.radius, request.repair, active->serial });
+	}
+}
+
+// publishes the changed tiles then drops cached paths through them and repairs handed out paths that are now blocked
+void Pathfinder::apply_changes() {
+	if (_dirty.empty()) {
+		return;
+	}
+
+	glm::ivec4 changed(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+	for (const auto tile : _dirty) {
+		_grid.update_tile(_terrain, tile.x, tile.y);
+		_dirty_flags[tile.y * _grid.get_width() + tile.x] = 0;
+
+		changed = glm::ivec4(std::min(changed.x, tile.x), std::min(changed.y, tile.y), std::max(changed.z, tile.x), std::max(changed.w, tile.y));
+	}
+	_dirty.clear();
+
+	_published = std::make_shared<const WalkGrid>(_grid);
+	++_revision;
+
+	_fields.clear();
+	rebuild_fields();
+
+	for (auto it = _cache.begin(); it != _cache.end();) {
+		const glm::ivec4& bounds = it->second.bounds;
+		if (bounds.x <= changed.z && bounds.z >= changed.x && bounds.y <= changed.w && bounds.w >= changed.y) {
+			it = _cache.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	const auto& ids = _active.ids();
+	auto& paths = _active.values();
+	for (int i = 0; i < _active.size(); ++i) {
+		ActivePath& path = paths[i];
+		if (path.waypoints.empty()) {
+			continue;
+		}
+
+		// only what is still ahead of the unit -- segments it already walked cant turn it back
+		const int waypoint = std::min(path.waypoint, (int)path.waypoints.size() - 1);
+		const int segment = broken_segment(path.position, path.waypoints, waypoint);
+		if (segment == -1) {
+			continue;
+		}
+
+		// keep everything up to the start of the broken segment and search on from there
+		// the unit's own position when it is on that segment now
+		const glm::vec3 from = segment == waypoint ? path.position : path.waypoints[segment - 1];
+		Request repair = { ids[i], path.serial, from, path.to, {}, true };
+		repair.prefix.assign(path.waypoints.begin(), path.waypoints.begin() + segment);
+		start(std::move(repair));
+	}
+}
+
+// ids following the same field share the rebuild
+void Pathfinder::rebuild_fields() {
+	std::unordered_map<const FlowField*, FieldRequest> rebuilds;
+
+	const auto& ids = _active.ids();
+	auto& paths = _active.values();
+	for (int i = 0; i < _active.size(); ++i) {
+		ActivePath& path = paths[i];
+		if (!path.field) {
+			continue;
+		}
+
+		auto& rebuild = rebuilds[path.field.get()];
+		if (rebuild.ids.empty()) {
+			rebuild.to = path.to;
+			rebuild.repair = true;
+		}
+
+		rebuild.ids.push_back(ids[i]);
+		rebuild.serials.push_back(path.serial);
+		rebuild.from.push_back(path.position);
+	}
+
+	for (auto& [field, rebuild] : rebuilds) {
+		rebuild.radius = FLOW_FIELD_ARRIVE_SPACING * std::sqrt((float)(rebuild.ids.size() - 1));
+		start_field(std::move(rebuild));
+	}
+}
+
+int Pathfinder::broken_segment(glm::vec3 from, const std::vector<glm::vec3>& waypoints, int first) {
+	glm::ivec2 a = _grid.get_tile(from);
+	for (int i = first; i < (int)waypoints.size(); ++i) {
+		const glm::ivec2 b = _grid.get_tile(waypoints[i]);
+		if (!segment_walkable(a, b)) {
+			return i;
+		}
+		a = b;
+	}
+
+	return -1;
+}
+
+// tiles along a to b -- a itself isnt checked, a unit can stand on a tile that has since been blocked
+bool Pathfinder::segment_walkable(glm::ivec2 a, glm::ivec2 b) {
+	const glm::ivec2 d = b - a;
+	const int steps = std::max(std::abs(d.x), std::abs(d.y));
+
+	glm::ivec2 previous = a;
+	for (int i = 1; i <= steps; ++i) {
+		const glm::ivec2 tile(a.x + (int)std::lround(d.x * (float)i / steps), a.y + (int)std::lround(d.y * (float)i / steps));
+		if (!_grid.walkable(tile.x, tile.y)) {
+			return false;
+		}
+
+		if (tile.x != previous.x && tile.y != previous.y && (!_grid.walkable(tile.x, previous.y) || !_grid.walkable(previous.x, tile.y))) {
+			return false;
+		}
+
+		previous = tile;
+	}
+
+	return true;
+}
+
+// tile centers after the start tile -- a path that reaches the goal ends on the exact point asked for
+std::vector<glm::vec3> Pathfinder::to_waypoints(const Found& found) {
+	std::vector<glm::vec3> waypoints = found.request.prefix;
+	waypoints.reserve(waypoints.size() + found.tiles.size());
+
+	for (size_t i = 1; i < found.tiles.size(); ++i) {
+		waypoints.push_back(_grid.get_position(found.tiles[i]));
+	}
+
+	if (found.reached) {
+		if (found.tiles.size() > 1) {
+			waypoints.back() = found.request.to;
+		}
+		else {
+			waypoints.push_back(found.request.to);
+		}
+	}
+
+	return waypoints;
+}
+
+uint64_t Pathfinder::cache_key(glm::ivec2 start, glm::ivec2 goal) {
+	const int width = _grid.get_width();
+	return ((uint64_t)(start.y * width + start.x) << 32) | (uint32_t)(goal.y * width + goal.x);
+}
+
+glm::ivec4 Pathfinder::tile_bounds(const std::vector<glm::ivec2>& tiles) {
+	glm::ivec4 bounds(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+	for (const auto tile : tiles) {
+		bounds = glm::ivec4(std::min(bounds.x, tile.x), std::min(bounds.y, tile.y), std::max(bounds.z, tile.x), std::max(bounds.w, tile.y));
+	}
+
+	return bounds;
+}
+
+std::unique_ptr<PathSearch> Pathfinder::acquire_search() {
+	std::lock_guard<std::mutex> lock(_search_mutex);
+	if (_searches.empty()) {
+		return std::make_unique<PathSearch>();
+	}
+
+	auto search = std::move(_searches.back());
+	_searches.pop_back();
+	return search;
+}
+
+void Pathfinder::release_search(std::unique_ptr<PathSearch> search) {
+	std::lock_guard<std::mutex> lock(_search_mutex);
+	_searches.push_back(std::move(search));
+}
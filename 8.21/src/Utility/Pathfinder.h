@@ -0,0 +1,251 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Collision.h"
+#include "SlotMap.h"
+#include "JobSystem.h"
+
+// finished tile paths kept for reuse -- the oldest is dropped past this
+#define PATH_CACHE_SIZE 1024
+
+#define PATH_DIAGONAL_COST 1.41421356f
+
+// room one unit of a group takes up around the destination -- a group stops within spacing * sqrt(units - 1) of it
+#define FLOW_FIELD_ARRIVE_SPACING 0.5f
+
+class TerrainData;
+class FlowField;
+
+/********************************************************************************************************************************************************/
+
+// One flag per terrain tile -- walkable terrain that nothing static stands on
+class WalkGrid {
+public:
+	WalkGrid();
+
+	void build(TerrainData* terrain);
+	// re-reads one tile's terrain
+	void update_tile(TerrainData* terrain, int x, int z);
+
+	// count is +1 when something is placed over box, -1 when it goes
+	void occupy(const CollisionBox& box, int count);
+
+	bool walkable(int x, int z) const;
+
+	// clamped to the map
+	glm::ivec2 get_tile(glm::vec3 position) const;
+	// tile center at y 0
+	glm::vec3 get_position(glm::ivec2 tile) const;
+
+	int get_width() const;
+	int get_length() const;
+private:
+	int _width;
+	int _length;
+	float _tile_width;
+	float _tile_length;
+
+	std::vector<uint8_t> _terrain;
+	std::vector<uint16_t> _occupied;
+};
+
+/********************************************************************************************************************************************************/
+
+// Jump point search over a WalkGrid -- 8 way, never cuts past a blocked corner
+// scratch for one search at a time, sized to the grid on first use
+class PathSearch {
+public:
+	PathSearch();
+
+	// jump points from start to goal -- or to the closest reachable tile if goal cant be reached
+	// false if start has nowhere to go
+	bool find(const WalkGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& points, bool* reached);
+private:
+	struct Open {
+		float f;
+		int node;
+
+		bool operator>(const Open& rhs) const { return f > rhs.f; }
+	};
+
+	bool walkable(int x, int z) const;
+	// next jump point from x, z going dx, dz -- -1 if there is none
+	int jump(int x, int z, int dx, int dz);
+	void successors(int node);
+	void open(int node, int parent, float g);
+	float heuristic(int node) const;
+
+	const WalkGrid* _grid;
+	int _width;
+	glm::ivec2 _goal;
+
+	std::vector<float> _g;
+	std::vector<int> _parent;
+	// search number that last opened / closed a node -- nothing is cleared between searches
+	std::vector<unsigned int> _opened;
+	std::vector<unsigned int> _closed;
+	unsigned int _search;
+
+	std::vector<Open> _open;
+	std::vector<int> _neighbours;
+};
+
+/********************************************************************************************************************************************************/
+
+// A path ready for an entity -- waypoints[first] is where it should head if it wasnt already further along
+// a group move hands out field instead -- waypoints is only the destination then
+struct PathResult {
+	SlotId id = INVALID_SLOT;
+	std::vector<glm::vec3> waypoints;
+	int first = 0;
+
+	std::shared_ptr<const FlowField> field;
+	float radius = 0.0f;
+	// a path or field rebuilt after the grid changed -- units that already arrived stay put
+	bool repair = false;
+
+	// hand back to progress() / arrived() so they only touch the path this result belongs to
+	unsigned int serial = 0;
+};
+
+// Tick thread service -- request() queues a search on a job system worker, update() hands back finished paths
+// request_group() builds one flow field on a worker instead of a search per unit
+// searches run on a copy of the walk grid so terrain changes never wait for them
+// paths already handed out are re-checked when tiles they cross change and only the broken part is searched again
+class Pathfinder {
+public:
+	Pathfinder();
+	~Pathfinder();
+
+	void build(TerrainData* terrain);
+
+	// the tile is re-read on the next update() -- its neighbours too, their edges may no longer meet it
+	void terrain_changed(int x, int z);
+	void occupy(const CollisionBox& box);
+	void vacate(const CollisionBox& box);
+
+	// replaces any path the entity was waiting for
+	void request(SlotId id, glm::vec3 from, glm::vec3 to);
+	// one flow field to the destination shared by every id -- ids that cant reach it from[i] get a path searched on their own
+	void request_group(const std::vector<SlotId>& ids, const std::vector<glm::vec3>& from, glm::vec3 to);
+	void cancel(SlotId id);
+
+	// where the unit following serial's path is and the waypoint it is heading for -- repairs start from here
+	void progress(SlotId id, unsigned int serial, glm::vec3 position, int waypoint);
+	// the unit got there -- its path is no longer checked when the grid changes
+	void arrived(SlotId id, unsigned int serial);
+
+	// applies grid changes and fills results with every path finished since the last call
+	void update(std::vector<PathResult>& results);
+private:
+	struct Request {
+		SlotId id;
+		unsigned int serial;
+		glm::vec3 from;
+		glm::vec3 to;
+		// waypoints kept ahead of a repaired section
+		std::vector<glm::vec3> prefix;
+		bool repair;
+	};
+
+	struct Found {
+		Request request;
+		unsigned int revision;
+		std::vector<glm::ivec2> tiles;
+		bool reached;
+		bool found;
+	};
+
+	struct FieldRequest {
+		std::vector<SlotId> ids;
+		std::vector<unsigned int> serials;
+		std::vector<glm::vec3> from;
+		glm::vec3 to;
+		float radius;
+		bool repair;
+	};
+
+	struct FoundField {
+		FieldRequest request;
+		std::shared_ptr<const FlowField> field;
+	};
+
+	struct ActivePath {
+		unsigned int serial;
+		glm::vec3 from;
+		glm::vec3 to;
+		std::vector<glm::vec3> waypoints;
+		std::shared_ptr<const FlowField> field;
+
+		// last progress() -- from and 0 until the unit reports
+		glm::vec3 position;
+		int waypoint;
+	};
+
+	struct CachedPath {
+		std::vector<glm::ivec2> tiles;
+		bool reached;
+		glm::ivec4 bounds;
+	};
+
+	void start(Request request);
+	void finish(Found& found, std::vector<PathResult>& results);
+	void start_field(FieldRequest request);
+	void finish_field(FoundField& found, std::vector<PathResult>& results);
+
+	void apply_changes();
+	// rebuilds the fields units are still following on the new grid
+	void rebuild_fields();
+	// first segment from, waypoints[first] ... that crosses a blocked tile -- -1 if none
+	int broken_segment(glm::vec3 from, const std::vector<glm::vec3>& waypoints, int first);
+	bool segment_walkable(glm::ivec2 a, glm::ivec2 b);
+
+	std::vector<glm::vec3> to_waypoints(const Found& found);
+	uint64_t cache_key(glm::ivec2 start, glm::ivec2 goal);
+	static glm::ivec4 tile_bounds(const std::vector<glm::ivec2>& tiles);
+
+	std::unique_ptr<PathSearch> acquire_search();
+	void release_search(std::unique_ptr<PathSearch> search);
+
+	TerrainData* _terrain;
+
+	// tick thread copy -- searches get _published
+	WalkGrid _grid;
+	std::shared_ptr<const WalkGrid> _published;
+	unsigned int _revision;
+
+	std::vector<glm::ivec2> _dirty;
+	std::vector<uint8_t> _dirty_flags;
+
+	// keyed by entity id
+	SlotMap<ActivePath> _active;
+	unsigned int _serial;
+
+	std::unordered_map<uint64_t, CachedPath> _cache;
+	std::deque<uint64_t> _cache_order;
+
+	// keyed by goal tile -- only fields built on _published, the units following them keep them alive
+	std::unordered_map<int, std::weak_ptr<const FlowField>> _fields;
+
+	std::vector<std::unique_ptr<PathSearch>> _searches;
+	std::mutex _search_mutex;
+
+	std::vector<Found> _found;
+	std::vector<Found> _finished;
+	std::vector<FoundField> _found_fields;
+	std::vector<FoundField> _finished_fields;
+	std::mutex _found_mutex;
+
+	JobCounter _pending;
+};
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <utility>
+
+// 32 bit id -- low SLOT_INDEX_BITS index, high bits generation
+typedef uint32_t SlotId;
+
+#define SLOT_INDEX_BITS 20
+#define SLOT_INDEX_MASK ((1u << SLOT_INDEX_BITS) - 1)
+#define SLOT_GENERATION_MASK ((1u << (32 - SLOT_INDEX_BITS)) - 1)
+
+#define INVALID_SLOT 0xFFFFFFFF
+
+inline uint32_t slot_index(SlotId id) { return id & SLOT_INDEX_MASK; }
+inline uint32_t slot_generation(SlotId id) { return id >> SLOT_INDEX_BITS; }
+inline SlotId make_slot_id(uint32_t index, uint32_t generation) { return ((generation & SLOT_GENERATION_MASK) << SLOT_INDEX_BITS) | index; }
+
+// Values packed in a dense vector, ids map to them through a sparse index -- O(1) without hashing
+// An id goes stale when its value is erased, the slot's generation moves on
+// A map either hands out ids with insert() or mirrors another map's ids with insert_at() -- not both
+template<typename T>
+class SlotMap {
+public:
+	SlotMap();
+
+	SlotId insert(T value);
+
+	// keeps id -- false if a live value already has its index
+	bool insert_at(SlotId id, T value);
+
+	// nullptr if the id is stale -- valid until the next insert or erase
+	T* get(SlotId id);
+	bool contains(SlotId id);
+
+	bool erase(SlotId id);
+	void clear();
+	void reserve(int size);
+
+	int size();
+	bool empty();
+
+	// dense order -- ids()[i] is the id of values()[i]
+	const std::vector<SlotId>& ids();
+	std::vector<T>& values();
+
+	typename std::vector<T>::iterator begin() { return _values.begin(); }
+	typename std::vector<T>::iterator end() { return _values.end(); }
+private:
+	struct Slot {
+		uint32_t dense = 0;
+		uint32_t generation = 0;
+		bool alive = false;
+	};
+
+	std::vector<Slot> _slots;
+	std::vector<T> _values;
+	std::vector<SlotId> _ids;
+
+	// oldest first so a slot's generation wraps as late as possible
+	std::deque<uint32_t> _free;
+
+	// ids come from insert_at() -- slots are never handed out so they arent kept free
+	bool _mirror;
+};
+
+template<typename T>
+SlotMap<T>::SlotMap() :
+	_mirror			( false )
+{}
+
+template<typename T>
+SlotId SlotMap<T>::insert(T value) {
+	uint32_t index;
+	if (!_free.empty()) {
+		index = _free.front();
+		_free.pop_front();
+	}
+	else {
+		index = (uint32_t)_slots.size();
+		if (index >= SLOT_INDEX_MASK) {
+			return INVALID_SLOT;
+		}
+		_slots.emplace_back();
+	}
+
+	Slot& slot = _slots[index];
+	slot.dense = (uint32_t)_values.size();
+	slot.alive = true;
+
+	const SlotId id = make_slot_id(index, slot.generation);
+	_values.push_back(std::move(value));
+	_ids.push_back(id);
+
+	return id;
+}
+
+template<typename T>
+bool SlotMap<T>::insert_at(SlotId id, T value) {
+	const uint32_t index = slot_index(id);
+	if (id == INVALID_SLOT || index >= SLOT_INDEX_MASK) {
+		return false;
+	}
+
+	if (index >= _slots.size()) {
+		_slots.resize(index + 1);
+	}
+
+	Slot& slot = _slots[index];
+	if (slot.alive) {
+		return false;
+	}
+	_mirror = true;
+
+	slot.dense = (uint32_t)_values.size();
+	slot.generation = slot_generation(id);
+	slot.alive = true;
+
+	_values.push_back(std::move(value));
+	_ids.push_back(id);
+
+	return true;
+}
+
+template<typename T>
+T* SlotMap<T>::get(SlotId id) {
+	const uint32_t index = slot_index(id);
+	if (index >= _slots.size()) {
+		return nullptr;
+	}
+
+	const Slot& slot = _slots[index];
+	if (!slot.alive || slot.generation != slot_generation(id)) {
+		return nullptr;
+	}
+
+	return &_values[slot.dense];
+}
+
+template<typename T>
+bool SlotMap<T>::contains(SlotId id) {
+	return get(id) != nullptr;
+}
+
+// swaps the last value into the hole
+template<typename T>
+bool SlotMap<T>::erase(SlotId id) {
+	if (!get(id)) {
+		return false;
+	}
+
+	Slot& slot = _slots[slot_index(id)];
+	const uint32_t dense = slot.dense;
+	const uint32_t last = (uint32_t)_values.size() - 1;
+
+	if (dense != last) {
+		_values[dense] = std::move(_values[last]);
+		_ids[dense] = _ids[last];
+		_slots[slot_index(_ids[dense])].dense = dense;
+	}
+	_values.pop_back();
+	_ids.pop_back();
+
+	slot.alive = false;
+	slot.generation = (slot.generation + 1) & SLOT_GENERATION_MASK;
+	if (!_mirror) {
+		_free.push_back(slot_index(id));
+	}
+
+	return true;
+}
+
+// ids handed out before stay stale
+template<typename T>
+void SlotMap<T>::clear() {
+	for (const auto id : _ids) {
+		Slot& slot = _slots[slot_index(id)];
+		slot.alive = false;
+		slot.generation = (slot.generation + 1) & SLOT_GENERATION_MASK;
+		if (!_mirror) {
+			_free.push_back(slot_index(id));
+		}
+	}
+
+	_values.clear();
+	_ids.clear();
+}
+
+template<typename T>
+void SlotMap<T>::reserve(int size) {
+	_values.reserve(size);
+	_ids.reserve(size);
+}
+
+template<typename T>
+int SlotMap<T>::size() {
+	return (int)_values.size();
+}
+
+template<typename T>
+bool SlotMap<T>::empty() {
+	return _values.empty();
+}
+
+template<typename T>
+const std::vector<SlotId>& SlotMap<T>::ids() {
+	return _ids;
+}
+
+template<typename T>
+std::vector<T>& SlotMap<T>::values() {
+	return _values;
+}
+
+#endif
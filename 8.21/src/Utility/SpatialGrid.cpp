@@ -0,0 +1,275 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "../src/Resources/Terrain.h"
+
+SpatialGrid::SpatialGrid() :
+	_width			( 1 ),
+	_length			( 1 ),
+	_cell_width		( 1.0f ),
+	_cell_length	( 1.0f ),
+	_query			( 0 )
+{
+	_cells.resize(1);
+}
+
+void SpatialGrid::resize(TerrainData* terrain) {
+	_cells.clear();
+	_entries.clear();
+
+	if (!terrain) {
+		_width = 1;
+		_length = 1;
+		_cells.resize(1);
+		return;
+	}
+
+	_cell_width = terrain->get_tile_width() * SPATIAL_CELL_TILES;
+	_cell_length = terrain->get_tile_length() * SPATIAL_CELL_TILES;
+
+	_width = std::max(1, (terrain->get_width() + SPATIAL_CELL_TILES - 1) / SPATIAL_CELL_TILES);
+	_length = std::max(1, (terrain->get_length() + SPATIAL_CELL_TILES - 1) / SPATIAL_CELL_TILES);
+
+	_cells.resize(_width * _length);
+}
+
+void SpatialGrid::clear() {
+	for (auto& cell : _cells) {
+		cell.clear();
+	}
+	_entries.clear();
+}
+
+void SpatialGrid::update(SlotId id, const CollisionBox& box) {
+	const CellRange cells = get_cells(box);
+
+	if (const auto entry = _entries.get(id)) {
+		entry->box = box;
+		if (entry->cells == cells) {
+			return;
+		}
+
+		unlink(id, entry->cells);
+		entry->cells = cells;
+	}
+	else if (!_entries.insert_at(id, { box, cells, 0 })) {
+		return;
+	}
+
+	link(id, cells);
+}
+
+void SpatialGrid::remove(SlotId id) {
+	const auto entry = _entries.get(id);
+	if (!entry) {
+		return;
+	}
+
+	unlink(id, entry->cells);
+	_entries.erase(id);
+}
+
+bool SpatialGrid::contains(SlotId id) {
+	return _entries.contains(id);
+}
+
+void SpatialGrid::query_box(const CollisionBox& box, std::vector<SlotId>& ids) {
+	next_query();
+
+	const CellRange cells = get_cells(box);
+	for (int z = cells.min.y; z <= cells.max.y; ++z) {
+		for (int x = cells.min.x; x <= cells.max.x; ++x) {
+			for (const auto id : _cells[z * _width + x]) {
+				Entry& entry = *_entries.get(id);
+				if (visit(entry) && xz_collision(box, entry.box)) {
+					ids.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+void SpatialGrid::query_radius(glm::vec3 center, float radius, std::vector<SlotId>& ids) {
+	next_query();
+
+	const CellRange cells = get_cells({ center - glm::vec3(radius), center + glm::vec3(radius) });
+	for (int z = cells.min.y; z <= cells.max.y; ++z) {
+		for (int x = cells.min.x; x <= cells.max.x; ++x) {
+			for (const auto id : _cells[z * _width + x]) {
+				Entry& entry = *_entries.get(id);
+				if (visit(entry) && xz_radius_collision(center, radius, entry.box)) {
+					ids.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+void SpatialGrid::query_candidates(const CollisionBox& box, std::vector<SlotId>& ids, std::vector<CollisionBox>& boxes) {
+	next_query();
+
+	const CellRange cells = get_cells(box);
+	for (int z = cells.min.y; z <= cells.max.y; ++z) {
+		for (int x = cells.min.x; x <= cells.max.x; ++x) {
+			for (const auto id : _cells[z * _width + x]) {
+				Entry& entry = *_entries.get(id);
+				if (visit(entry)) {
+					ids.push_back(id);
+					boxes.push_back(entry.box);
+				}
+			}
+		}
+	}
+}
+
+// Walks the cells under the ray on xz in order (Amanatides & Woo) and tests each box once
+void SpatialGrid::query_ray(glm::vec3 origin, glm::vec3 dir, float max_distance, std::vector<SlotId>& ids) {
+	const float length = glm::length(dir);
+	if (length == 0.0f) {
+		return;
+	}
+	dir /= length;
+
+	next_query();
+	_hits.clear();
+
+	// clip the ray to the grid on xz
+	const float grid_max[2] = { _width * _cell_width, _length * _cell_length };
+	const float o[2] = { origin.x, origin.z };
+	const float d[2] = { dir.x, dir.z };
+
+	float t_enter = 0.0f;
+	float t_exit = max_distance;
+	for (int i = 0; i < 2; ++i) {
+		if (d[i] == 0.0f) {
+			if (o[i] < 0.0f || o[i] > grid_max[i]) {
+				return;
+			}
+			continue;
+		}
+
+		float t1 = (0.0f - o[i]) / d[i];
+		float t2 = (grid_max[i] - o[i]) / d[i];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+
+		t_enter = std::max(t_enter, t1);
+		t_exit = std::min(t_exit, t2);
+	}
+	if (t_enter > t_exit) {
+		return;
+	}
+
+	const glm::vec3 start = origin + dir * t_enter;
+	glm::ivec2 cell = get_cell(start.x, start.z);
+
+	const int step_x = dir.x > 0.0f ? 1 : -1;
+	const int step_z = dir.z > 0.0f ? 1 : -1;
+
+	const float infinity = std::numeric_limits<float>::max();
+
+	// distance along the ray to the next x / z cell edge and between edges
+	float next_x = infinity;
+	float next_z = infinity;
+	float delta_x = infinity;
+	float delta_z = infinity;
+	if (dir.x != 0.0f) {
+		next_x = ((cell.x + (step_x > 0 ? 1 : 0)) * _cell_width - origin.x) / dir.x;
+		delta_x = _cell_width / std::abs(dir.x);
+	}
+	if (dir.z != 0.0f) {
+		next_z = ((cell.y + (step_z > 0 ? 1 : 0)) * _cell_length - origin.z) / dir.z;
+		delta_z = _cell_length / std::abs(dir.z);
+	}
+
+	while (cell.x >= 0 && cell.x < _width && cell.y >= 0 && cell.y < _length) {
+		for (const auto id : _cells[cell.y * _width + cell.x]) {
+			Entry& entry = *_entries.get(id);
+			float t;
+			if (visit(entry) && ray_collision(origin, dir, entry.box, &t) && t <= max_distance) {
+				_hits.push_back({ t, id });
+			}
+		}
+
+		const float t_next = std::min(next_x, next_z);
+		if (t_next > t_exit) {
+			break;
+		}
+
+		if (next_x < next_z) {
+			cell.x += step_x;
+			next_x += delta_x;
+		}
+		else {
+			cell.y += step_z;
+			next_z += delta_z;
+		}
+	}
+
+	std::sort(_hits.begin(), _hits.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	for (const auto& hit : _hits) {
+		ids.push_back(hit.second);
+	}
+}
+
+// clamped to the grid -- entities off the map stay in the edge cells
+glm::ivec2 SpatialGrid::get_cell(float x, float z) {
+	const int cx = (int)std::floor(x / _cell_width);
+	const int cz = (int)std::floor(z / _cell_length);
+
+	return glm::ivec2(std::clamp(cx, 0, _width - 1), std::clamp(cz, 0, _length - 1));
+}
+
+SpatialGrid::CellRange SpatialGrid::get_cells(const CollisionBox& box) {
+	const glm::vec3 min = glm::min(box.min, box.max);
+	const glm::vec3 max = glm::max(box.min, box.max);
+
+	return { get_cell(min.x, min.z), get_cell(max.x, max.z) };
+}
+
+void SpatialGrid::link(SlotId id, const CellRange& cells) {
+	for (int z = cells.min.y; z <= cells.max.y; ++z) {
+		for (int x = cells.min.x; x <= cells.max.x; ++x) {
+			_cells[z * _width + x].push_back(id);
+		}
+	}
+}
+
+void SpatialGrid::unlink(SlotId id, const CellRange& cells) {
+	for (int z = cells.min.y; z <= cells.max.y; ++z) {
+		for (int x = cells.min.x; x <= cells.max.x; ++x) {
+			auto& cell = _cells[z * _width + x];
+			const auto e = std::find(cell.begin(), cell.end(), id);
+			if (e != cell.end()) {
+				*e = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+void SpatialGrid::next_query() {
+	// wrapped -- old marks could match the new query
+	if (++_query == 0) {
+		for (auto& entry : _entries) {
+			entry.query = 0;
+		}
+		_query = 1;
+	}
+}
+
+bool SpatialGrid::visit(Entry& entry) {
+	if (entry.query == _query) {
+		return false;
+	}
+
+	entry.query = _query;
+	return true;
+}
@@ -0,0 +1,86 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "Collision.h"
+#include "SlotMap.h"
+
+// terrain tiles per side of a spatial grid cell
+#define SPATIAL_CELL_TILES 2
+
+class TerrainData;
+
+// Uniform grid over the terrain -- entities are kept in every cell their collision box covers on xz
+// queries only visit the cells they touch so they cost what they find, not the size of the world
+// not thread safe -- the owner locks around it
+class SpatialGrid {
+public:
+	SpatialGrid();
+
+	// drops every entity
+	void resize(TerrainData* terrain);
+	void clear();
+
+	// adds the entity or moves it -- cells only change when the box covers different ones
+	void update(SlotId id, const CollisionBox& box);
+	void remove(SlotId id);
+	bool contains(SlotId id);
+
+	// ids are appended -- each entity once
+	// boxes overlapping box on xz
+	void query_box(const CollisionBox& box, std::vector<SlotId>& ids);
+	// boxes within radius of center on xz
+	void query_radius(glm::vec3 center, float radius, std::vector<SlotId>& ids);
+	// boxes the ray hits within max_distance world units -- nearest first
+	void query_ray(glm::vec3 origin, glm::vec3 dir, float max_distance, std::vector<SlotId>& ids);
+
+	// broadphase -- everything filed in the cells box covers with the box it was filed with, no overlap test
+	void query_candidates(const CollisionBox& box, std::vector<SlotId>& ids, std::vector<CollisionBox>& boxes);
+private:
+	// cells x / z an entity covers -- inclusive
+	struct CellRange {
+		glm::ivec2 min;
+		glm::ivec2 max;
+
+		bool operator==(const CellRange& rhs) const { return min == rhs.min && max == rhs.max; }
+	};
+
+	struct Entry {
+		CollisionBox box;
+		CellRange cells;
+		// last query that saw the entry -- entries in several cells are only tested once
+		unsigned int query;
+	};
+
+	glm::ivec2 get_cell(float x, float z);
+	CellRange get_cells(const CollisionBox& box);
+
+	void link(SlotId id, const CellRange& cells);
+	void unlink(SlotId id, const CellRange& cells);
+
+	// starts a query -- every entry is unseen again
+	void next_query();
+	// true the first time the current query meets the entry
+	bool visit(Entry& entry);
+
+	int _width;
+	int _length;
+	float _cell_width;
+	float _cell_length;
+
+	std::vector<std::vector<SlotId>> _cells;
+
+	// mirrors the entity manager's ids
+	SlotMap<Entry> _entries;
+
+	unsigned int _query;
+
+	// distance, id -- reused by query_ray()
+	std::vector<std::pair<float, SlotId>> _hits;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "Tick.h"
+
+#include "../src/Utility/FileReader.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+
+#pragma comment(lib, "Winmm.lib")
+#endif
+
+#define FILE_TICK_RATE "i_server_tick_rate"
+
+// if the server falls this many ticks behind it stops trying to catch up
+#define MAX_TICK_LAG 5
+
+// last stretch before a tick is spun instead of slept -- Sleep() overshoots
+constexpr auto TICK_SPIN_TIME = std::chrono::microseconds(1500);
+
+int tick_load_rate(const char* file_path) {
+	FileReader file(file_path);
+
+	int rate = DEFAULT_TICK_RATE;
+	file.s_read(&rate, FILE_TICK_RATE, "System");
+
+	return rate > 0 ? rate : DEFAULT_TICK_RATE;
+}
+
+Tick::Tick(const int rate) :
+	_rate				( rate > 0 ? rate : DEFAULT_TICK_RATE ),
+	_step				( std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / _rate)) ),
+	_next				( clock::now() ),
+	_start				( _next ),
+	_interval_start		( _next ),
+	_ticks				( 0 ),
+	_overruns			( 0 ),
+	_total_ms			( 0.0 ),
+	_max_ms				( 0.0 )
+{
+#ifdef _WIN32
+	// 1ms scheduler resolution while ticking
+	timeBeginPeriod(1);
+#endif
+}
+
+Tick::~Tick() {
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void Tick::start() {
+	_start = clock::now();
+}
+
+void Tick::finish() {
+	const auto end = clock::now();
+	const double ms = std::chrono::duration<double, std::milli>(end - _start).count();
+
+	++_ticks;
+	_total_ms += ms;
+	if (ms > _max_ms) {
+		_max_ms = ms;
+	}
+
+	_next += _step;
+	if (end > _next) {
+		++_overruns;
+
+		// too far behind -- drop the missed ticks instead of running them back to back
+		if (end - _next > _step * MAX_TICK_LAG) {
+			_next = end;
+		}
+		return;
+	}
+
+	sleep_until(_next);
+}
+
+bool Tick::update(const double interval) {
+	return clock::now() - _interval_start >= std::chrono::duration<double>(interval);
+}
+
+void Tick::reset_stats() {
+	_interval_start = clock::now();
+	_ticks = 0;
+	_overruns = 0;
+	_total_ms = 0.0;
+	_max_ms = 0.0;
+}
+
+int Tick::get_rate() {
+	return _rate;
+}
+
+double Tick::get_dt() {
+	return 1.0 / _rate;
+}
+
+unsigned int Tick::get_ticks() {
+	return _ticks;
+}
+
+unsigned int Tick::get_overruns() {
+	return _overruns;
+}
+
+double Tick::get_average_ms() {
+	return _ticks > 0 ? _total_ms / _ticks : 0.0;
+}
+
+double Tick::get_max_ms() {
+	return _max_ms;
+}
+
+void Tick::sleep_until(clock::time_point time) {
+	const auto sleep_time = time - TICK_SPIN_TIME;
+	if (clock::now() < sleep_time) {
+		std::this_thread::sleep_until(sleep_time);
+	}
+
+	while (clock::now() < time) {
+		std::this_thread::yield();
+	}
+}
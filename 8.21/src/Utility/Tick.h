@@ -0,0 +1,52 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include <chrono>
+
+#define DEFAULT_TICK_RATE 20
+
+#define TICK_FILE "Data/system.txt"
+
+int tick_load_rate(const char* file_path = TICK_FILE);
+
+// Fixed rate scheduler for the server simulation
+// start() / finish() wrap the work done in one tick
+class Tick {
+public:
+	Tick(const int rate = tick_load_rate());
+	~Tick();
+
+	void start();
+
+	// records the work time then sleeps until the next tick is due
+	void finish();
+
+	// returns true once each interval -- stats cover that interval
+	bool update(const double interval = 1.0);
+	void reset_stats();
+
+	int get_rate();
+	double get_dt();
+
+	unsigned int get_ticks();
+	unsigned int get_overruns();
+	double get_average_ms();
+	double get_max_ms();
+private:
+	typedef std::chrono::steady_clock clock;
+
+	int _rate;
+	clock::duration _step;
+	clock::time_point _next;
+	clock::time_point _start;
+	clock::time_point _interval_start;
+
+	unsigned int _ticks;
+	unsigned int _overruns;
+	double _total_ms;
+	double _max_ms;
+
+	void sleep_until(clock::time_point time);
+};
+
+#endif